@@ -0,0 +1,344 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#include <algorithm>
+
+#include <QDir>
+#include <QFile>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#include <numaif.h>
+#endif
+
+#include "affinity.h"
+#include "trace.h"
+
+struct AffinityTopology
+{
+    // Usable CPUs sorted by node, and the node of every one of them.
+    QVector<int> cpus;
+    QVector<int> nodes;
+    int nodeCount;
+};
+
+#ifdef Q_OS_LINUX
+static bool cpuAllowed(const cpu_set_t &allowed, int cpu)
+{
+    return cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed);
+}
+#endif
+
+#if defined(Q_OS_LINUX) && !defined(HAVE_LIBNUMA)
+// Parses lists like "0-3,8-11".
+static QVector<int> parseCpuList(const QByteArray &list)
+{
+    QVector<int> cpus;
+
+    for (const QByteArray &item: list.trimmed().split(',')) {
+        if (item.isEmpty())
+            continue;
+
+        QList<QByteArray> bounds = item.split('-');
+        int first = bounds.first().toInt();
+        int last = bounds.last().toInt();
+
+        for (int cpu = first; cpu <= last; cpu++)
+            cpus << cpu;
+    }
+
+    return cpus;
+}
+#endif
+
+static AffinityTopology readTopology()
+{
+    AffinityTopology topology;
+    topology.nodeCount = 0;
+
+#ifdef Q_OS_LINUX
+    // Containers and taskset may restrict the CPUs we can use.
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed))
+        CPU_ZERO(&allowed);
+
+#ifdef HAVE_LIBNUMA
+    if (numa_available() >= 0) {
+        struct bitmask *mask = numa_allocate_cpumask();
+        int cpus = numa_num_configured_cpus();
+
+        for (int node = 0; node <= numa_max_node(); node++) {
+            if (numa_node_to_cpus(node, mask))
+                continue;
+
+            bool used = false;
+
+            for (int cpu = 0; cpu < cpus; cpu++)
+                if (numa_bitmask_isbitset(mask, cpu) && cpuAllowed(allowed, cpu)) {
+                    topology.cpus << cpu;
+                    topology.nodes << node;
+                    used = true;
+                }
+
+            if (used)
+                topology.nodeCount++;
+        }
+
+        numa_free_cpumask(mask);
+    }
+#else
+    QDir nodesDir("/sys/devices/system/node");
+    QStringList nodeDirs = nodesDir.entryList(QStringList() << "node*",
+                                              QDir::Dirs);
+    QVector<int> nodes;
+
+    for (const QString &nodeDir: nodeDirs) {
+        bool ok = false;
+        int node = nodeDir.mid(4).toInt(&ok);
+
+        if (ok)
+            nodes << node;
+    }
+
+    std::sort(nodes.begin(), nodes.end());
+
+    for (int node: nodes) {
+        QFile cpuList(nodesDir.filePath(QString("node%1/cpulist").arg(node)));
+
+        if (!cpuList.open(QIODevice::ReadOnly))
+            continue;
+
+        bool used = false;
+
+        for (int cpu: parseCpuList(cpuList.readAll()))
+            if (cpuAllowed(allowed, cpu)) {
+                topology.cpus << cpu;
+                topology.nodes << node;
+                used = true;
+            }
+
+        if (used)
+            topology.nodeCount++;
+    }
+#endif
+#endif
+
+    if (topology.cpus.isEmpty()) {
+        int cpus = qMax(1, QThread::idealThreadCount());
+
+        for (int cpu = 0; cpu < cpus; cpu++) {
+            topology.cpus << cpu;
+            topology.nodes << 0;
+        }
+
+        topology.nodeCount = 1;
+    }
+
+    return topology;
+}
+
+static const AffinityTopology &topology()
+{
+    static const AffinityTopology topology = readTopology();
+
+    return topology;
+}
+
+// The CPU worker runs on, workers are spread evenly over the CPUs, so
+// consecutive workers, and the consecutive blocks they run, share a node.
+static int workerCpuIndex(int worker, int workers)
+{
+    return int(qint64(worker) * topology().cpus.size() / qMax(workers, 1));
+}
+
+// Pins the current thread to a CPU and restores its previous affinity when
+// destroyed, pool threads are shared with code that doesn't expect them
+// pinned.
+class AffinityPin
+{
+    public:
+        AffinityPin(int cpu):
+            m_pinned(false)
+        {
+#ifdef Q_OS_LINUX
+            if (pthread_getaffinity_np(pthread_self(),
+                                       sizeof(cpu_set_t),
+                                       &this->m_previous))
+                return;
+
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            this->m_pinned = !pthread_setaffinity_np(pthread_self(),
+                                                     sizeof(cpu_set_t),
+                                                     &set);
+#else
+            Q_UNUSED(cpu)
+#endif
+        }
+
+        ~AffinityPin()
+        {
+#ifdef Q_OS_LINUX
+            if (this->m_pinned)
+                pthread_setaffinity_np(pthread_self(),
+                                       sizeof(cpu_set_t),
+                                       &this->m_previous);
+#endif
+        }
+
+    private:
+        bool m_pinned;
+#ifdef Q_OS_LINUX
+        cpu_set_t m_previous;
+#endif
+
+        Q_DISABLE_COPY(AffinityPin)
+};
+
+static void runBlock(const Range &block,
+                     int worker,
+                     int workers,
+                     const std::function<void (const Range &)> &function)
+{
+    TRACE_SCOPE("affinityFor", block.size());
+
+    // A single node has nothing to place, don't pay for the system calls.
+    if (topology().nodeCount < 2) {
+        function(block);
+
+        return;
+    }
+
+    AffinityPin pin(topology().cpus[workerCpuIndex(worker, workers)]);
+    function(block);
+}
+
+class AffinityWorker: public QRunnable
+{
+    public:
+        AffinityWorker(const Range &block,
+                       int worker,
+                       int workers,
+                       const std::function<void (const Range &)> &function,
+                       QSemaphore *done):
+            m_block(block),
+            m_worker(worker),
+            m_workers(workers),
+            m_function(function),
+            m_done(done)
+        {
+        }
+
+        void run()
+        {
+            runBlock(this->m_block,
+                     this->m_worker,
+                     this->m_workers,
+                     this->m_function);
+            this->m_done->release();
+        }
+
+    private:
+        Range m_block;
+        int m_worker;
+        int m_workers;
+        const std::function<void (const Range &)> &m_function;
+        QSemaphore *m_done;
+};
+
+int affinityNodeCount()
+{
+    return topology().nodeCount;
+}
+
+QVector<int> affinityCpus()
+{
+    return topology().cpus;
+}
+
+int affinityWorkerNode(int worker, int workers)
+{
+    return topology().nodes[workerCpuIndex(worker, workers)];
+}
+
+int affinityPageNode(const void *address)
+{
+#ifdef HAVE_LIBNUMA
+    void *page = const_cast<void *>(address);
+    int status = -1;
+
+    if (numa_available() < 0
+        || move_pages(0, 1, &page, nullptr, &status, 0)
+        || status < 0)
+        return -1;
+
+    return status;
+#else
+    Q_UNUSED(address)
+
+    return -1;
+#endif
+}
+
+void affinityFor(const Range &range,
+                 const std::function<void (const Range &block)> &function)
+{
+    if (range.isEmpty())
+        return;
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    QVector<Range> blocks = range.split(qMax(1, pool->maxThreadCount()));
+    int workers = blocks.size();
+    QSemaphore done;
+    QVector<int> notStarted;
+
+    // The calling thread runs the first block. It may be a pool thread
+    // itself, so only free threads are used, and the calling thread runs
+    // the blocks of the workers that didn't start too, on their CPUs.
+    for (int i = 1; i < workers; i++) {
+        AffinityWorker *worker =
+                new AffinityWorker(blocks[i], i, workers, function, &done);
+
+        if (!pool->tryStart(worker)) {
+            delete worker;
+            notStarted << i;
+        }
+    }
+
+    runBlock(blocks[0], 0, workers, function);
+
+    for (int i: notStarted)
+        runBlock(blocks[i], i, workers, function);
+
+    done.acquire(workers - 1 - notStarted.size());
+}
@@ -0,0 +1,76 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+#include <functional>
+
+#include "range.h"
+
+// Number of NUMA nodes the process can run on. The topology is read with
+// libnuma when the project is built with it, from sysfs on Linux otherwise,
+// and machines where neither works are seen as a single node.
+int affinityNodeCount();
+
+// CPUs the process can run on, sorted by NUMA node.
+QVector<int> affinityCpus();
+
+// NUMA node of the CPU that runs worker out of workers in affinityFor().
+int affinityWorkerNode(int worker, int workers);
+
+// NUMA node where the page that holds address is placed, or -1 if unknown
+// (not touched yet, or built without libnuma).
+int affinityPageNode(const void *address);
+
+// Runs function(const Range &block) over range with a static partition: the
+// range is split in one contiguous block per thread of the global pool, and
+// worker i always runs block i pinned to a CPU of a fixed NUMA node, with the
+// blocks of every node consecutive.
+// So the same range with the same number of threads gives every index to the
+// same node on every call, and memory first touched by one call is local to
+// the threads that use it in the next ones. On single node machines the
+// partition is the same but threads are not pinned.
+// Blocks of workers that find no free thread in the pool are run by the
+// calling thread, so it can be called from a task of the pool.
+void affinityFor(const Range &range,
+                 const std::function<void (const Range &block)> &function);
+
+// Allocates size elements without touching them, and initializes every
+// element with init(index) from the node that affinityFor(Range(size), ...)
+// gives that index, so the operating system places every page there.
+// The buffer must be released with delete [].
+template <typename T, typename Function>
+T *affinityFirstTouch(int size, Function init)
+{
+    // Only types without constructors are left untouched by new [].
+    Q_STATIC_ASSERT(std::is_trivial<T>::value);
+    T *buffer = new T[size];
+
+    affinityFor(Range(size), [buffer, &init] (const Range &block) {
+        for (int i: block)
+            buffer[i] = init(i);
+    });
+
+    return buffer;
+}
+
+#endif // AFFINITY_H
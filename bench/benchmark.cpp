@@ -0,0 +1,210 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QtDebug>
+
+#include "benchmark.h"
+#include "trace.h"
+
+Benchmark::Benchmark(int warmup, int repetitions):
+    m_warmup(qMax(warmup, 0)),
+    m_repetitions(qMax(repetitions, 1)),
+    m_size(0),
+    m_threads(1)
+{
+}
+
+int Benchmark::warmup() const
+{
+    return this->m_warmup;
+}
+
+int Benchmark::repetitions() const
+{
+    return this->m_repetitions;
+}
+
+QString Benchmark::filter() const
+{
+    return this->m_filter;
+}
+
+void Benchmark::setFilter(const QString &filter)
+{
+    this->m_filter = filter;
+}
+
+void Benchmark::setGroup(const QString &group)
+{
+    this->m_group = group;
+}
+
+void Benchmark::setSize(qint64 size)
+{
+    this->m_size = size;
+}
+
+void Benchmark::setThreads(int threads)
+{
+    this->m_threads = threads;
+}
+
+bool Benchmark::run(const QString &name,
+                    qint64 bytes,
+                    const std::function<bool ()> &function)
+{
+    QString fullName = this->m_group + "/" + name;
+
+    if (!this->m_filter.isEmpty() && !fullName.contains(this->m_filter))
+        return true;
+
+    bool valid = true;
+
+    for (int i = 0; i < this->m_warmup; i++)
+        valid &= function();
+
+    int n = this->m_repetitions;
+    QVector<double> times(n);
+    QElapsedTimer timer;
+    qint64 traceFrom = traceTimestamp();
+
+    for (int i = 0; i < this->m_repetitions; i++) {
+        timer.start();
+        valid &= function();
+        times[i] = timer.nsecsElapsed() / 1.0e6;
+    }
+
+    TraceStats trace = traceStats(traceFrom, traceTimestamp());
+    QString traceInfo;
+
+    if (traceIsRecording() && trace.tasks > 0)
+        traceInfo = QString(" tasks=%1 threads=%2 imbalance=%3% overhead=%4%")
+                    .arg(trace.tasks / n)
+                    .arg(trace.threads)
+                    .arg(100 * trace.imbalance, 0, 'f', 1)
+                    .arg(100 * trace.overhead, 0, 'f', 1);
+
+    std::sort(times.begin(), times.end());
+
+    BenchmarkResult result;
+    result.group = this->m_group;
+    result.name = name;
+    result.size = this->m_size;
+    result.threads = this->m_threads;
+    result.repetitions = n;
+    result.median = n & 0x1?
+                        times[n / 2]:
+                        (times[n / 2 - 1] + times[n / 2]) / 2;
+    result.p95 = times[qBound(0, int(std::ceil(0.95 * n)) - 1, n - 1)];
+    result.min = times[0];
+    result.throughput = result.median > 0?
+                            bytes / (result.median * 1.0e6):
+                            0;
+    result.valid = valid;
+    this->m_results << result;
+
+    qInfo().noquote()
+            << QString("%1 size=%2 threads=%3 median=%4ms p95=%5ms %6GB/s%7%8")
+               .arg(fullName)
+               .arg(result.size)
+               .arg(result.threads)
+               .arg(result.median, 0, 'f', 3)
+               .arg(result.p95, 0, 'f', 3)
+               .arg(result.throughput, 0, 'f', 2)
+               .arg(traceInfo)
+               .arg(valid? "": " WRONG RESULT");
+
+    return valid;
+}
+
+const QVector<BenchmarkResult> &Benchmark::results() const
+{
+    return this->m_results;
+}
+
+bool Benchmark::writeCsv(const QString &fileName) const
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Can't write" << fileName << file.errorString();
+
+        return false;
+    }
+
+    QTextStream csv(&file);
+    csv << "group,name,size,threads,repetitions,"
+           "median_ms,p95_ms,min_ms,throughput_gbps,valid\n";
+
+    for (const BenchmarkResult &result: this->m_results)
+        csv << result.group << ','
+            << result.name << ','
+            << result.size << ','
+            << result.threads << ','
+            << result.repetitions << ','
+            << result.median << ','
+            << result.p95 << ','
+            << result.min << ','
+            << result.throughput << ','
+            << (result.valid? "true": "false") << '\n';
+
+    return true;
+}
+
+bool Benchmark::writeJson(const QString &fileName) const
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Can't write" << fileName << file.errorString();
+
+        return false;
+    }
+
+    QJsonArray results;
+
+    for (const BenchmarkResult &result: this->m_results) {
+        QJsonObject object;
+        object["group"] = result.group;
+        object["name"] = result.name;
+        object["size"] = result.size;
+        object["threads"] = result.threads;
+        object["repetitions"] = result.repetitions;
+        object["median_ms"] = result.median;
+        object["p95_ms"] = result.p95;
+        object["min_ms"] = result.min;
+        object["throughput_gbps"] = result.throughput;
+        object["valid"] = result.valid;
+        results.append(object);
+    }
+
+    file.write(QJsonDocument(results).toJson());
+
+    return true;
+}
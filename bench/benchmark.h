@@ -0,0 +1,80 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <functional>
+#include <QString>
+#include <QVector>
+
+struct BenchmarkResult
+{
+    QString group;
+    QString name;
+    qint64 size;
+    int threads;
+    int repetitions;
+    double median;
+    double p95;
+    double min;
+    double throughput;
+    bool valid;
+};
+
+// Times a set of strategies over the same workload. Times are reported in
+// milliseconds and throughputs in GB/s.
+class Benchmark
+{
+    public:
+        Benchmark(int warmup=2, int repetitions=10);
+        int warmup() const;
+        int repetitions() const;
+        QString filter() const;
+        void setFilter(const QString &filter);
+        void setGroup(const QString &group);
+        void setSize(qint64 size);
+        void setThreads(int threads);
+
+        // Runs function warmup() + repetitions() times and records the
+        // timing statistics. function returns whether the result it
+        // computed is correct, and bytes is the amount of memory it is
+        // supposed to touch in one run.
+        // Returns false if the strategy gave a wrong result.
+        bool run(const QString &name,
+                 qint64 bytes,
+                 const std::function<bool ()> &function);
+
+        const QVector<BenchmarkResult> &results() const;
+        bool writeCsv(const QString &fileName) const;
+        bool writeJson(const QString &fileName) const;
+
+    private:
+        int m_warmup;
+        int m_repetitions;
+        QString m_filter;
+        QString m_group;
+        qint64 m_size;
+        int m_threads;
+        QVector<BenchmarkResult> m_results;
+};
+
+#endif // BENCHMARK_H
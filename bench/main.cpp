@@ -0,0 +1,1712 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QtConcurrent>
+
+#include "affinity.h"
+#include "benchmark.h"
+#include "curve.h"
+#include "histogram.h"
+#include "indexset.h"
+#include "kernels.h"
+#include "mapped.h"
+#include "pairwise.h"
+#include "parallel.h"
+#include "pipeline.h"
+#include "rangend.h"
+#include "reduction.h"
+#include "scan.h"
+#include "stream.h"
+#include "trace.h"
+#include "workstealing.h"
+
+#define BUFFERSIZE (3 * 7 * 11 * 13 * 17 * 19 * 23)
+#define STENCIL_WIDTH 4096
+#define STENCIL_TILE_HEIGHT 64
+#define STENCIL_TILE_WIDTH 256
+#define SKEWED_MAX_COST 256
+#define SKEWED_MAX_SIZE (1 << 20)
+#define STRESS_SIZE Q_INT64_C(8000000000)
+#define STREAM_GRAIN (1 << 14)
+#define STREAM_WINDOW 8
+#define STREAM_CONSUMER_DELAY 20
+#define REDUCTION_JOBS 4
+#define HISTOGRAM_SMALL_BINS 128
+#define HISTOGRAM_LARGE_BINS (1 << 16)
+#define PAIRWISE_TOLERANCE 1e-6
+#define PAIRWISE_THREADS 2, 3, 8, 13
+#define FAST_SUM_TOLERANCE 1e-3
+#define ELEMENTWISE_ALPHA 0.75f
+#define ELEMENTWISE_TOLERANCE 1e-5f
+#define INDEXSET_RUN_GAP 61
+#define MAPPED_WRITE_SIZE (1 << 20)
+#define KERNELS_MAX_OFFSET 3
+#define KERNELS_MAX_SIZE ((1 << 16) + 1)
+
+static QList<qint64> parseList(const QString &list)
+{
+    QList<qint64> values;
+
+    for (const QString &value: list.split(',')) {
+        bool ok = false;
+        qint64 n = value.toLongLong(&ok);
+
+        if (ok && n > 0)
+            values << n;
+    }
+
+    return values;
+}
+
+inline int halfSize(int size)
+{
+    return (size + (size & 0x1)) / 2;
+}
+
+// The level by level tree reduction main.cpp used to do, every level halves
+// the buffer with the given map function. The levels alternate between two
+// scratch buffers of context.
+template <typename MapFunction>
+static quint32 treeSum(const quint32 *input,
+                       int size,
+                       ReductionContext *context,
+                       MapFunction map)
+{
+    quint32 *bufferP[2] = {
+        context->scratch<quint32>(0, halfSize(size)),
+        context->scratch<quint32>(1, halfSize(halfSize(size)))
+    };
+    const quint32 *in = input;
+    int buffN = 0;
+
+    for (int inSize = size, outSize = halfSize(inSize);
+         inSize > 1;
+         inSize = outSize, outSize = halfSize(inSize)) {
+        quint32 *out = bufferP[buffN];
+
+        map(Range(outSize), [in, out, inSize] (int i) {
+            int next = 2 * i + 1;
+
+            if (next < inSize)
+                out[i] = in[2 * i] + in[next];
+            else
+                out[i] = in[2 * i];
+        });
+
+        in = out;
+        buffN = 1 - buffN;
+    }
+
+    return size > 0? in[0]: 0;
+}
+
+static void benchSum(Benchmark &bench, const QVector<quint32> &buffer, int size)
+{
+    bench.setGroup("sum");
+    const quint32 *in = buffer.constData();
+    qint64 bytes = qint64(size) * sizeof(quint32);
+
+    quint32 expected = 0;
+
+    for (int i = 0; i < size; i++)
+        expected += in[i];
+
+    auto add = [] (quint32 a, quint32 b) {
+        return a + b;
+    };
+
+    bench.run("serial", bytes, [in, size, expected] () {
+        quint32 sum = 0;
+
+        for (int i = 0; i < size; i++)
+            sum += in[i];
+
+        return sum == expected;
+    });
+
+    ReductionContext context;
+
+    bench.run("blockingMap", bytes, [&] () {
+        auto map = [] (Range range, std::function<void (int)> function) {
+            QtConcurrent::blockingMap(range, function);
+        };
+
+        return treeSum(in, size, &context, map) == expected;
+    });
+
+    bench.run("parallelFor", bytes, [&] () {
+        auto map = [] (const Range &range, std::function<void (int)> function) {
+            parallelFor(range, [&function] (const Range &chunk) {
+                for (int i: chunk)
+                    function(i);
+            });
+        };
+
+        return treeSum(in, size, &context, map) == expected;
+    });
+
+    bench.run("parallelReduce", bytes, [&] () {
+        quint32 sum = parallelReduce(Range(size),
+                                     quint32(0),
+                                     [in] (int i) {
+                                         return in[i];
+                                     },
+                                     add);
+
+        return sum == expected;
+    });
+
+    for (int isa = KernelIsaScalar; isa <= kernelBestIsa(); isa++) {
+        setKernelIsa(KernelIsa(isa));
+
+        bench.run(QString("parallelBlockReduce+%1")
+                  .arg(kernelIsaName(KernelIsa(isa))),
+                  bytes,
+                  [&] () {
+            quint32 sum = parallelBlockReduce<quint32>(Range(size),
+                                                       [&buffer] (const Range &block) {
+                return kernelSum(buffer, block);
+            }, add);
+
+            return sum == expected;
+        });
+    }
+
+    setKernelIsa(kernelBestIsa());
+}
+
+// Runs every integer kernel over the sizes, starting at every offset of the
+// buffers, and returns all their results in a single vector.
+static QVector<quint32> integerKernelsResults(const QVector<quint32> &a,
+                                              const QVector<quint32> &b,
+                                              const QVector<RangeType> &values,
+                                              const QVector<int> &sizes)
+{
+    QVector<quint32> results;
+    QVector<RangeType> iota(sizes.last() + KERNELS_MAX_OFFSET);
+    QVector<bool> contains(sizes.last() + KERNELS_MAX_OFFSET);
+
+    // Elements and sizes that wrap around the ends of RangeType.
+    RangeType max = std::numeric_limits<RangeType>::max();
+    RangeType min = std::numeric_limits<RangeType>::min();
+    Range ranges[] {
+        Range(-sizes.last(), 7 * sizes.last(), 7),
+        Range(max, min, -5),
+    };
+
+    for (int offset = 0; offset <= KERNELS_MAX_OFFSET; offset++)
+        for (int size: sizes) {
+            const quint32 *pa = a.constData() + offset;
+            const quint32 *pb = b.constData() + offset;
+            results << kernelSum(pa, size)
+                    << kernelMin(pa, size)
+                    << kernelMax(pa, size)
+                    << kernelDot(pa, pb, size);
+
+            kernelIota(iota.data() + offset, size, max - RangeType(size), 3);
+
+            for (int i = 0; i < size; i++)
+                results << quint32(iota[offset + i]);
+
+            kernelIota(iota.data() + offset, size, min + RangeType(size), -7);
+
+            for (int i = 0; i < size; i++)
+                results << quint32(iota[offset + i]);
+
+            for (const Range &range: ranges) {
+                kernelContainsMany(range,
+                                   values.constData() + offset,
+                                   size,
+                                   contains.data() + offset);
+
+                for (int i = 0; i < size; i++)
+                    results << quint32(contains[offset + i]);
+            }
+        }
+
+    return results;
+}
+
+// The integer kernels of every instruction set against the scalar ones, bit
+// for bit, with sizes around the vector widths, every misalignment of the
+// buffers, and values whose sums and products wrap around.
+static void benchKernels(Benchmark &bench, int size)
+{
+    bench.setGroup("kernels");
+    size = qMin(size, KERNELS_MAX_SIZE);
+    QVector<int> sizes;
+
+    for (int n: {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33,
+                 63, 64, 65, 127, 128, 129, 1000, 4099})
+        if (n < size)
+            sizes << n;
+
+    sizes << size;
+    QVector<quint32> a(size + KERNELS_MAX_OFFSET);
+    QVector<quint32> b(size + KERNELS_MAX_OFFSET);
+    QVector<RangeType> values(size + KERNELS_MAX_OFFSET);
+
+    for (int i = 0; i < a.size(); i++) {
+        a[i] = quint32(qrand()) << 16 ^ quint32(qrand());
+        b[i] = quint32(qrand()) << 16 ^ quint32(qrand());
+        values[i] = RangeType(a[i] ^ b[i]);
+    }
+
+    // The identities of min and max, at both ends of the buffers.
+    a[0] = std::numeric_limits<quint32>::max();
+    a[a.size() - 1] = 0;
+
+    for (int i = 0; i < values.size(); i += 4)
+        values[i] = RangeType(7 * (i / 4)) - size;
+
+    qint64 bytes = 0;
+
+    for (int n: sizes)
+        bytes += qint64(KERNELS_MAX_OFFSET + 1) * n
+                 * (2 * sizeof(quint32) + 3 * sizeof(RangeType));
+
+    setKernelIsa(KernelIsaScalar);
+    QVector<quint32> expected = integerKernelsResults(a, b, values, sizes);
+
+    for (int isa = KernelIsaScalar; isa <= kernelBestIsa(); isa++) {
+        setKernelIsa(KernelIsa(isa));
+
+        bench.run(QString("integer+%1").arg(kernelIsaName(KernelIsa(isa))),
+                  bytes,
+                  [&] () {
+            return integerKernelsResults(a, b, values, sizes) == expected;
+        });
+    }
+
+    setKernelIsa(kernelBestIsa());
+}
+
+// Float sums with the fast reduction, whose partial sums depend on the
+// number of threads, and with the pairwise sums, which must give the same
+// bits for every number of threads. The reference sums are taken with a
+// single thread, and checked against PAIRWISE_THREADS other thread counts
+// before timing, so the check doesn't depend on the --threads the benchmark
+// runs with. The strided range goes through the slow path of the leaves.
+static void benchPairwise(Benchmark &bench,
+                          const QVector<quint32> &buffer,
+                          int size)
+{
+    bench.setGroup("pairwise");
+    QVector<float> values(size);
+
+    // Values from 0.001 to 128, the small ones are lost by a float
+    // accumulator long before the end of the buffer.
+    for (int i = 0; i < size; i++)
+        values[i] = float(buffer[i] + 1) / float(1 + i % 1000);
+
+    auto exactSum = [&values] (const Range &range) {
+        double exact = 0;
+
+        for (int i: range)
+            exact += values[i];
+
+        return exact;
+    };
+
+    auto close = [] (float sum, double exact, double tolerance) {
+        return qAbs(sum - exact) <= tolerance * qAbs(exact);
+    };
+
+    double exact = exactSum(Range(size));
+
+    bench.run("parallelBlockReduce", qint64(size) * sizeof(float), [&] () {
+        float sum = parallelBlockReduce<float>(Range(size),
+                                               [&values] (const Range &block) {
+            return kernelSum(values, block);
+        }, [] (float a, float b) {
+            return a + b;
+        });
+
+        return close(sum, exact, FAST_SUM_TOLERANCE);
+    });
+
+    ReductionContext context;
+    QThreadPool *pool = QThreadPool::globalInstance();
+    int threads = pool->maxThreadCount();
+    const char *names[] = {"pairwise", "pairwise+kahan", "pairwise+neumaier"};
+    Range ranges[] {Range(size), Range(size - 1, -1, -3)};
+    const char *rangeNames[] {"", "+strided"};
+
+    for (int r = 0; r < 2; r++) {
+        const Range &range = ranges[r];
+        double rangeExact = exactSum(range);
+        qint64 bytes = range.size() * qint64(sizeof(float));
+
+        for (int mode = PairwiseCompensationNone;
+             mode <= PairwiseCompensationNeumaier;
+             mode++) {
+            auto sum = [&] () {
+                return pairwiseSum(values,
+                                   range,
+                                   PairwiseCompensation(mode),
+                                   &context);
+            };
+
+            pool->setMaxThreadCount(1);
+            float reference = sum();
+            bool deterministic = true;
+
+            for (int n: {PAIRWISE_THREADS}) {
+                pool->setMaxThreadCount(n);
+                deterministic &= sum() == reference;
+            }
+
+            pool->setMaxThreadCount(threads);
+            bool valid = deterministic
+                         && close(reference, rangeExact, PAIRWISE_TOLERANCE);
+
+            bench.run(QString(names[mode]) + rangeNames[r], bytes, [&] () {
+                return valid && sum() == reference;
+            });
+        }
+    }
+}
+
+// REDUCTION_JOBS independent sums running at the same time, like a service
+// answering several requests. Every job either allocates the scratch of its
+// tree reduction or takes a context from the pool.
+static void benchReduction(Benchmark &bench,
+                           const QVector<quint32> &buffer,
+                           int size)
+{
+    bench.setGroup("reduction");
+    const quint32 *in = buffer.constData();
+    qint64 bytes = REDUCTION_JOBS * qint64(size) * sizeof(quint32);
+    quint32 expected = 0;
+
+    for (int i = 0; i < size; i++)
+        expected += in[i];
+
+    auto map = [] (const Range &range, std::function<void (int)> function) {
+        parallelFor(range, [&function] (const Range &chunk) {
+            for (int i: chunk)
+                function(i);
+        });
+    };
+
+    auto runJobs = [] (const std::function<quint32 ()> &job) {
+        QVector<QFuture<quint32>> jobs;
+
+        for (int i = 0; i < REDUCTION_JOBS; i++)
+            jobs << QtConcurrent::run(job);
+
+        quint32 sum = 0;
+
+        for (QFuture<quint32> &future: jobs)
+            sum += future.result();
+
+        return sum;
+    };
+
+    bench.run("treeSum+allocate", bytes, [&] () {
+        quint32 sum = runJobs([&] () {
+            ReductionContext context;
+
+            return treeSum(in, size, &context, map);
+        });
+
+        return sum == REDUCTION_JOBS * expected;
+    });
+
+    bench.run("treeSum+pool", bytes, [&] () {
+        quint32 sum = runJobs([&] () {
+            ReductionContext *context = ReductionPool::globalInstance()->acquire();
+            quint32 sum = treeSum(in, size, context, map);
+            ReductionPool::globalInstance()->release(context);
+
+            return sum;
+        });
+
+        return sum == REDUCTION_JOBS * expected;
+    });
+
+    bench.run("blockReduce+pool", bytes, [&] () {
+        quint32 sum = runJobs([&] () {
+            ReductionContext *context = ReductionPool::globalInstance()->acquire();
+            quint32 sum = context->blockReduce<quint32>(Range(size),
+                                                        [&buffer] (const Range &block) {
+                return kernelSum(buffer, block);
+            }, [] (quint32 a, quint32 b) {
+                return a + b;
+            });
+            ReductionPool::globalInstance()->release(context);
+
+            return sum;
+        });
+
+        return sum == REDUCTION_JOBS * expected;
+    });
+}
+
+// Writes set to a QDataStream and reads it back, the copy must be equal to
+// set.
+static bool indexSetRoundTrip(const IndexSet &set)
+{
+    QByteArray data;
+    QDataStream ostream(&data, QIODevice::WriteOnly);
+    ostream << set;
+    IndexSet read;
+    QDataStream istream(data);
+    istream >> read;
+
+    return istream.status() == QDataStream::Ok && read == set;
+}
+
+// Sets that are built without going through the set operations, with single
+// index containers and with the ends of the int range.
+static bool indexSetEdgesRoundTrip()
+{
+    int max = std::numeric_limits<int>::max();
+    int min = std::numeric_limits<int>::min();
+    IndexSet added;
+    added.add(5);
+    added.add(1 << 20);
+    IndexSet bounds;
+    bounds.add(min);
+    bounds.add(max);
+    QVector<IndexSet> sets {
+        IndexSet(Range(5, 6)),
+        IndexSet(Range(0, (1 << 16) + 1)),
+        IndexSet(Range(max - 10, max)) | IndexSet(Range(max, max - 1, -1)),
+        IndexSet(Range(max, max - 1, -1)),
+        added,
+        bounds,
+    };
+
+    for (const IndexSet &set: sets)
+        if (!indexSetRoundTrip(set)
+            || set != IndexSet(set.runs())
+            || set != (set | IndexSet())
+            || set != (set & set))
+            return false;
+
+    return true;
+}
+
+// A sparse selection made of runs of every length, dense and strided
+// regions, stored as the list of its indexes and as an IndexSet.
+static void benchIndexSet(Benchmark &bench, const QVector<quint32> &buffer, int size)
+{
+    bench.setGroup("indexset");
+    const quint32 *in = buffer.constData();
+    IndexSet set;
+
+    for (int first = 0; first < size; first += INDEXSET_RUN_GAP * 2) {
+        int length = qrand() % INDEXSET_RUN_GAP + 1;
+        set |= Range(first, qMin(first + length, size));
+    }
+
+    set |= Range(size / 2, size, 3);
+    IndexSet other(Range(size / 3, size, 2));
+    QList<int> list;
+
+    for (int i: set)
+        list << i;
+
+    QVector<int> expectedUnion = (set | other).toVector();
+    QVector<int> expectedIntersection;
+    quint32 expected = 0;
+
+    for (int i: list) {
+        expected += in[i];
+
+        if (other.contains(i))
+            expectedIntersection << i;
+    }
+
+    qint64 bytes = set.count() * qint64(sizeof(quint32));
+
+    bench.run("QList", bytes, [&] () {
+        quint32 sum = 0;
+
+        for (int i: list)
+            sum += in[i];
+
+        return sum == expected;
+    });
+
+    bench.run("IndexSet", bytes, [&] () {
+        quint32 sum = 0;
+
+        for (int i: set)
+            sum += in[i];
+
+        return sum == expected;
+    });
+
+    bench.run("parallelFor(IndexSet)", bytes, [&] () {
+        QAtomicInteger<quint32> sum(0);
+
+        parallelFor(set, [in, &sum] (const IndexSet &part) {
+            quint32 partSum = 0;
+
+            for (int i: part)
+                partSum += in[i];
+
+            sum.fetchAndAddRelaxed(partSum);
+        });
+
+        return sum.load() == expected;
+    });
+
+    bench.run("union", bytes, [&] () {
+        return (set | other).toVector() == expectedUnion;
+    });
+
+    bench.run("intersection", bytes, [&] () {
+        return (set & other).toVector() == expectedIntersection;
+    });
+
+    bool edgesValid = indexSetEdgesRoundTrip();
+
+    bench.run("QDataStream", bytes, [&] () {
+        return edgesValid && indexSetRoundTrip(set);
+    });
+}
+
+// Histograms and sums by key of the buffer, with the 128 keys of its values
+// and with a hash of the index spread over many bins. The atomic versions
+// add every element to a shared array.
+static void benchHistogram(Benchmark &bench,
+                           const QVector<quint32> &buffer,
+                           int size)
+{
+    bench.setGroup("histogram");
+    const quint32 *in = buffer.constData();
+    ReductionContext context;
+
+    for (int bins: {HISTOGRAM_SMALL_BINS, HISTOGRAM_LARGE_BINS}) {
+        auto key = [in, bins] (int i) {
+            return bins == HISTOGRAM_SMALL_BINS?
+                        int(in[i]):
+                        int((quint32(i) * 0x9e3779b1u) >> 16) & (bins - 1);
+        };
+
+        auto value = [in] (int i) {
+            return qint64(in[i]);
+        };
+
+        QVector<qint64> expectedCounts(bins, 0);
+        QVector<qint64> expectedSums(bins, 0);
+
+        for (int i = 0; i < size; i++) {
+            expectedCounts[key(i)]++;
+            expectedSums[key(i)] += value(i);
+        }
+
+        qint64 bytes = qint64(size) * sizeof(quint32);
+        QVector<QAtomicInteger<qint64>> shared(bins);
+
+        auto sharedMatches = [&] (const QVector<qint64> &expected) {
+            for (int bin = 0; bin < bins; bin++)
+                if (shared[bin].load() != expected[bin])
+                    return false;
+
+            return true;
+        };
+
+        bench.run(QString("serial+%1").arg(bins), bytes, [&] () {
+            QVector<qint64> counts(bins, 0);
+
+            for (int i = 0; i < size; i++)
+                counts[key(i)]++;
+
+            return counts == expectedCounts;
+        });
+
+        bench.run(QString("blockingMap+atomic+%1").arg(bins), bytes, [&] () {
+            for (QAtomicInteger<qint64> &bin: shared)
+                bin.store(0);
+
+            QtConcurrent::blockingMap(Range(size), [&] (int i) {
+                shared[key(i)].fetchAndAddRelaxed(1);
+            });
+
+            return sharedMatches(expectedCounts);
+        });
+
+        bench.run(QString("parallelFor+atomic+%1").arg(bins), bytes, [&] () {
+            for (QAtomicInteger<qint64> &bin: shared)
+                bin.store(0);
+
+            parallelFor(Range(size), [&] (const Range &chunk) {
+                for (int i: chunk)
+                    shared[key(i)].fetchAndAddRelaxed(1);
+            });
+
+            return sharedMatches(expectedCounts);
+        });
+
+        bench.run(QString("parallelHistogram+%1").arg(bins), bytes, [&] () {
+            return parallelHistogram(Range(size), key, bins) == expectedCounts;
+        });
+
+        bench.run(QString("parallelHistogram+context+%1").arg(bins),
+                  bytes,
+                  [&] () {
+            return parallelHistogram(Range(size), key, bins, &context)
+                   == expectedCounts;
+        });
+
+        bench.run(QString("parallelReduceByKey+%1").arg(bins), bytes, [&] () {
+            return parallelReduceByKey<qint64>(Range(size),
+                                               key,
+                                               value,
+                                               bins,
+                                               &context) == expectedSums;
+        });
+    }
+}
+
+// The in place scans of the first elements of buffer against the serial
+// prefix sums, with sizes that don't split evenly between the threads.
+static bool scanInPlaceMatches(const QVector<quint32> &buffer, int size)
+{
+    for (int n: {0, 1, 2, 3, 5, 1021, size - 1, size}) {
+        if (n < 0 || n > size)
+            continue;
+
+        QVector<quint32> inclusive(n);
+        QVector<quint32> exclusive(n);
+        quint32 sum = 0;
+
+        for (int i = 0; i < n; i++) {
+            exclusive[i] = sum;
+            sum += buffer[i];
+            inclusive[i] = sum;
+        }
+
+        QVector<quint32> values = buffer.mid(0, n);
+        parallelInclusiveScan(values);
+
+        if (values != inclusive)
+            return false;
+
+        values = buffer.mid(0, n);
+        parallelExclusiveScan(values);
+
+        if (values != exclusive)
+            return false;
+    }
+
+    return true;
+}
+
+static void benchScan(Benchmark &bench, const QVector<quint32> &buffer, int size)
+{
+    bench.setGroup("scan");
+    const quint32 *in = buffer.constData();
+
+    // Every element is read and written once, at least.
+    qint64 bytes = 2 * qint64(size) * sizeof(quint32);
+    QVector<quint32> inclusive(size);
+    QVector<quint32> exclusive(size);
+    QVector<quint32> output(size);
+    quint32 *out = output.data();
+    quint32 sum = 0;
+
+    for (int i = 0; i < size; i++) {
+        exclusive[i] = sum;
+        sum += in[i];
+        inclusive[i] = sum;
+    }
+
+    bench.run("serialInclusive", bytes, [&] () {
+        quint32 sum = 0;
+
+        for (int i = 0; i < size; i++) {
+            sum += in[i];
+            out[i] = sum;
+        }
+
+        return output == inclusive;
+    });
+
+    bench.run("parallelInclusiveScan", bytes, [&] () {
+        parallelInclusiveScan(Range(size), in, out);
+
+        return output == inclusive;
+    });
+
+    bench.run("parallelExclusiveScan", bytes, [&] () {
+        parallelExclusiveScan(Range(size), in, out);
+
+        return output == exclusive;
+    });
+
+    bool inPlaceValid = scanInPlaceMatches(buffer, size);
+
+    // The in place scans start from a copy of the input, which is timed too.
+    bench.run("parallelInclusiveScan(QVector)", bytes, [&] () {
+        std::copy(in, in + size, out);
+        parallelInclusiveScan(output);
+
+        return inPlaceValid && output == inclusive;
+    });
+
+    bench.run("parallelExclusiveScan(QVector)", bytes, [&] () {
+        std::copy(in, in + size, out);
+        parallelExclusiveScan(output);
+
+        return inPlaceValid && output == exclusive;
+    });
+}
+
+static void benchFill(Benchmark &bench, int size)
+{
+    bench.setGroup("fill");
+    Range range(-size, 2 * size, 3);
+    int n = int(range.size());
+    qint64 bytes = qint64(n) * sizeof(RangeType);
+    QVector<RangeType> expected(n);
+    QVector<RangeType> output(n);
+
+    for (int i = 0; i < n; i++)
+        expected[i] = range.at(i);
+
+    bench.run("toVector", bytes, [&] () {
+        return range.toVector() == expected;
+    });
+
+    bench.run("fillInto", bytes, [&] () {
+        range.fillInto(output);
+
+        return output == expected;
+    });
+
+    for (int isa = KernelIsaScalar; isa <= kernelBestIsa(); isa++) {
+        setKernelIsa(KernelIsa(isa));
+
+        bench.run(QString("parallelFillInto+%1")
+                  .arg(kernelIsaName(KernelIsa(isa))),
+                  bytes,
+                  [&] () {
+            parallelFillInto(range, output);
+
+            return output == expected;
+        });
+    }
+
+    setKernelIsa(kernelBestIsa());
+}
+
+// The elementwise float kernels against the same loops with blockingMap.
+static void benchElementwise(Benchmark &bench,
+                             const QVector<quint32> &buffer,
+                             int size)
+{
+    bench.setGroup("elementwise");
+    QVector<float> a(size);
+    QVector<float> b(size);
+    QVector<float> c(size);
+    QVector<float> output(size);
+    QVector<float> expected(size);
+    QVector<quint32> integers(size);
+
+    for (int i = 0; i < size; i++) {
+        a[i] = float(qrand() % 4096) / 128 - 16;
+        b[i] = float(qrand() % 4096) / 128 - 16;
+        c[i] = float(qrand() % 4096) / 128 - 16;
+
+        // Spread the values over the 32 bits, so the conversion rounds.
+        integers[i] = buffer[i] * 0x2000001u + quint32(i);
+    }
+
+    const float *in = a.constData();
+    const float *in2 = b.constData();
+    const float *in3 = c.constData();
+    const quint32 *inI = integers.constData();
+    float *out = output.data();
+
+    struct Operation
+    {
+        QString name;
+        int bytesPerElement;
+        bool exact;
+        std::function<void (int)> element;
+        std::function<void (const Range &)> chunk;
+    };
+
+    // axpy works in place, every pass starts from a copy of c.
+    QVector<Operation> operations {
+        {"add", 3 * sizeof(float), true,
+         [=] (int i) {
+             out[i] = in[i] + in2[i];
+         },
+         [&] (const Range &chunk) {
+             kernelAdd(output, a, b, chunk);
+         }},
+        {"mul", 3 * sizeof(float), true,
+         [=] (int i) {
+             out[i] = in[i] * in2[i];
+         },
+         [&] (const Range &chunk) {
+             kernelMul(output, a, b, chunk);
+         }},
+        {"fma", 4 * sizeof(float), false,
+         [=] (int i) {
+             out[i] = in[i] * in2[i] + in3[i];
+         },
+         [&] (const Range &chunk) {
+             kernelFma(output, a, b, c, chunk);
+         }},
+        {"axpy", 3 * sizeof(float), false,
+         [=] (int i) {
+             out[i] = in3[i];
+             out[i] += ELEMENTWISE_ALPHA * in[i];
+         },
+         [&] (const Range &chunk) {
+             std::copy(in3 + chunk.start(), in3 + chunk.stop(), out + chunk.start());
+             kernelAxpy(output, ELEMENTWISE_ALPHA, a, chunk);
+         }},
+        {"clamp", 2 * sizeof(float), true,
+         [=] (int i) {
+             out[i] = qBound(-4.0f, in[i], 4.0f);
+         },
+         [&] (const Range &chunk) {
+             kernelClamp(output, a, -4.0f, 4.0f, chunk);
+         }},
+        {"convert", sizeof(quint32) + sizeof(float), true,
+         [=] (int i) {
+             out[i] = float(inI[i]);
+         },
+         [&] (const Range &chunk) {
+             kernelConvert(output, integers, chunk);
+         }},
+    };
+
+    // fma and axpy round the product only on some instruction sets, so they
+    // are compared with a tolerance.
+    auto close = [&] (bool exact) {
+        if (exact)
+            return output == expected;
+
+        for (int i = 0; i < size; i++)
+            if (qAbs(output[i] - expected[i])
+                > ELEMENTWISE_TOLERANCE * (qAbs(expected[i]) + 1))
+                return false;
+
+        return true;
+    };
+
+    for (const Operation &operation: operations) {
+        qint64 bytes = qint64(size) * operation.bytesPerElement;
+
+        for (int i = 0; i < size; i++)
+            operation.element(i);
+
+        expected = output;
+
+        bench.run(QString("%1+blockingMap").arg(operation.name),
+                  bytes,
+                  [&] () {
+            QtConcurrent::blockingMap(Range(size), operation.element);
+
+            return output == expected;
+        });
+
+        for (int isa = KernelIsaScalar; isa <= kernelBestIsa(); isa++) {
+            setKernelIsa(KernelIsa(isa));
+
+            // Checking the tolerance costs more than the kernels, so it's
+            // done once, and the timed passes compare with the first one.
+            parallelFor(Range(size), operation.chunk);
+            bool valid = close(operation.exact);
+            QVector<float> first = output;
+
+            bench.run(QString("%1+%2")
+                      .arg(operation.name)
+                      .arg(kernelIsaName(KernelIsa(isa))),
+                      bytes,
+                      [&] () {
+                parallelFor(Range(size), operation.chunk);
+
+                return valid && output == first;
+            });
+        }
+
+        setKernelIsa(kernelBestIsa());
+    }
+}
+
+// Tests random values against a stepped range, a quarter of them are in it.
+static void benchMembership(Benchmark &bench, int size)
+{
+    bench.setGroup("membership");
+    Range range(-size, 7 * size, 7);
+    qint64 bytes = qint64(size) * (sizeof(RangeType) + sizeof(bool));
+    QVector<RangeType> values(size);
+    QVector<bool> expected(size);
+    QVector<bool> output(size);
+    bool *out = output.data();
+
+    for (int i = 0; i < size; i++) {
+        values[i] = i % 4?
+                        RangeType(qrand() % (8 * size)) - size:
+                        range.at(qrand() % range.size());
+        qint64 distance = qint64(values[i]) - range.start();
+        expected[i] = distance >= 0
+                      && distance % range.step() == 0
+                      && distance / range.step() < range.size();
+    }
+
+    const RangeType *in = values.constData();
+
+    bench.run("division", bytes, [&] () {
+        RangeType start = range.start();
+        RangeType step = range.step();
+        int count = int(range.size());
+
+        for (int i = 0; i < size; i++) {
+            RangeType distance = in[i] - start;
+            out[i] = distance >= 0
+                     && distance % step == 0
+                     && distance / step < count;
+        }
+
+        return output == expected;
+    });
+
+    bench.run("contains", bytes, [&] () {
+        for (int i = 0; i < size; i++)
+            out[i] = range.contains(in[i]);
+
+        return output == expected;
+    });
+
+    bench.run("containsMany", bytes, [&] () {
+        range.containsMany(in, size, out);
+
+        return output == expected;
+    });
+
+    for (int isa = KernelIsaScalar; isa <= kernelBestIsa(); isa++) {
+        setKernelIsa(KernelIsa(isa));
+
+        bench.run(QString("kernelContainsMany+%1")
+                  .arg(kernelIsaName(KernelIsa(isa))),
+                  bytes,
+                  [&] () {
+            kernelContainsMany(range, in, size, out);
+
+            return output == expected;
+        });
+    }
+
+    setKernelIsa(kernelBestIsa());
+}
+
+// Keeps the odd values of the buffer multiplied by 3, first with a
+// QtConcurrent pass per stage, then with the stages fused in a pipeline.
+static void benchPipeline(Benchmark &bench,
+                          const QVector<quint32> &buffer,
+                          int size)
+{
+    bench.setGroup("pipeline");
+    const quint32 *in = buffer.constData();
+    qint64 bytes = qint64(size) * sizeof(quint32);
+    QVector<quint32> expected;
+    quint32 expectedSum = 0;
+
+    for (int i = 0; i < size; i++)
+        if (in[i] & 0x1) {
+            expected << 3 * in[i];
+            expectedSum += 3 * in[i];
+        }
+
+    auto add = [] (quint32 a, quint32 b) {
+        return a + b;
+    };
+
+    auto load = [in] (int i) {
+        return in[i];
+    };
+
+    auto isOdd = [] (quint32 value) {
+        return (value & 0x1) != 0;
+    };
+
+    auto triple = [] (quint32 value) {
+        return 3 * value;
+    };
+
+    QVector<quint32> output;
+
+    bench.run("materialized", bytes, [&] () {
+        QVector<quint32> values(size);
+        quint32 *out = values.data();
+
+        parallelFor(Range(size), [in, out] (const Range &chunk) {
+            for (int i: chunk)
+                out[i] = in[i];
+        });
+
+        values = QtConcurrent::blockingFiltered(values, isOdd);
+        QtConcurrent::blockingMap(values, [triple] (quint32 &value) {
+            value = triple(value);
+        });
+
+        return values == expected;
+    });
+
+    bench.run("fusedCollect", bytes, [&] () {
+        Range(size).map(load).filter(isOdd).map(triple).collect(output);
+
+        return output == expected;
+    });
+
+    bench.run("fusedReduce", bytes, [&] () {
+        quint32 sum = Range(size)
+                      .map(load)
+                      .filter(isOdd)
+                      .map(triple)
+                      .reduce(quint32(0), add);
+
+        return sum == expectedSum;
+    });
+}
+
+// 5 points stencil with clamped borders.
+inline quint32 stencil(const quint32 *in, int width, int height, int x, int y)
+{
+    int xl = qMax(x - 1, 0);
+    int xr = qMin(x + 1, width - 1);
+    int yu = qMax(y - 1, 0);
+    int yd = qMin(y + 1, height - 1);
+
+    return in[y * width + x]
+           + in[y * width + xl]
+           + in[y * width + xr]
+           + in[yu * width + x]
+           + in[yd * width + x];
+}
+
+static void benchStencil(Benchmark &bench,
+                         const QVector<quint32> &buffer,
+                         int size)
+{
+    int width = STENCIL_WIDTH;
+    int height = size / width;
+
+    if (height < 1)
+        return;
+
+    size = width * height;
+    bench.setGroup("stencil");
+    bench.setSize(size);
+    const quint32 *in = buffer.constData();
+    qint64 bytes = 2 * qint64(size) * sizeof(quint32);
+    QVector<quint32> expected(size);
+    QVector<quint32> output(size);
+    quint32 *out = output.data();
+
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            expected[y * width + x] = stencil(in, width, height, x, y);
+
+    bench.run("flatRange", bytes, [&] () {
+        parallelFor(Range(size), [=] (const Range &chunk) {
+            for (int i: chunk) {
+                int y = i / width;
+                int x = i % width;
+                out[i] = stencil(in, width, height, x, y);
+            }
+        });
+
+        return output == expected;
+    });
+
+    bench.run("tiledRange2D", bytes, [&] () {
+        Range2D image(Range(0, height), Range(0, width));
+        Range2D::Shape tileShape {STENCIL_TILE_HEIGHT, STENCIL_TILE_WIDTH};
+
+        parallelFor(image, tileShape, [=] (const Range2D &tile) {
+            for (int y: tile.axis(0))
+                for (int x: tile.axis(1))
+                    out[y * width + x] = stencil(in, width, height, x, y);
+        });
+
+        return output == expected;
+    });
+}
+
+// Transposes and blurs an image walking it row by row, in tiles and along
+// space filling curves. The transpose writes a column for every row it
+// reads, so the row by row walk touches a different cache line, and often a
+// different page, for every point.
+static void benchCurve(Benchmark &bench,
+                       const QVector<quint32> &buffer,
+                       int size)
+{
+    int width = STENCIL_WIDTH;
+    int height = size / width;
+
+    if (height < 1)
+        return;
+
+    size = width * height;
+    bench.setGroup("curve");
+    bench.setSize(size);
+    const quint32 *in = buffer.constData();
+    qint64 bytes = 2 * qint64(size) * sizeof(quint32);
+    QVector<quint32> expectedTranspose(size);
+    QVector<quint32> expectedBlur(size);
+    QVector<quint32> output(size);
+    quint32 *out = output.data();
+    Range2D image(Range(0, height), Range(0, width));
+    Range2D::Shape tileShape {STENCIL_TILE_HEIGHT, STENCIL_TILE_WIDTH};
+
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++) {
+            expectedTranspose[x * height + y] = in[y * width + x];
+            expectedBlur[y * width + x] = stencil(in, width, height, x, y);
+        }
+
+    auto transpose = [=] (int y, int x) {
+        out[x * height + y] = in[y * width + x];
+    };
+
+    auto blur = [=] (int y, int x) {
+        out[y * width + x] = stencil(in, width, height, x, y);
+    };
+
+    auto run = [&] (const QString &name,
+                    const QVector<quint32> &expected,
+                    auto point) {
+        bench.run(name + "+rowMajor", bytes, [&] () {
+            parallelFor(Range(height), [point, width] (const Range &rows) {
+                for (int y: rows)
+                    for (int x = 0; x < width; x++)
+                        point(y, x);
+            });
+
+            return output == expected;
+        });
+
+        bench.run(name + "+tiledRange2D", bytes, [&] () {
+            parallelFor(image, tileShape, [point] (const Range2D &tile) {
+                for (int y: tile.axis(0))
+                    for (int x: tile.axis(1))
+                        point(y, x);
+            });
+
+            return output == expected;
+        });
+
+        bench.run(name + "+morton", bytes, [&] () {
+            parallelFor(RangeCurve(image, CurveOrderMorton),
+                        [point] (const RangeCurve &segment) {
+                segment.forEach([point] (const Range2D::Index &index) {
+                    point(index[0], index[1]);
+                });
+            });
+
+            return output == expected;
+        });
+
+        bench.run(name + "+hilbert", bytes, [&] () {
+            parallelFor(RangeCurve(image, CurveOrderHilbert),
+                        [point] (const RangeCurve &segment) {
+                segment.forEach([point] (const Range2D::Index &index) {
+                    point(index[0], index[1]);
+                });
+            });
+
+            return output == expected;
+        });
+    };
+
+    run("transpose", expectedTranspose, transpose);
+    run("blur", expectedBlur, blur);
+}
+
+// Per index work that grows linearly with the index, so the last blocks of
+// the range cost a lot more than the first ones.
+inline quint32 skewedWork(int i, int size)
+{
+    int iterations = 1 + int(qint64(SKEWED_MAX_COST) * i / size);
+    quint32 x = quint32(i) + 1;
+
+    for (int j = 0; j < iterations; j++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+    }
+
+    return x;
+}
+
+static void benchSkewed(Benchmark &bench, int size)
+{
+    // The skewed workload is much heavier than a sum, keep it reasonable.
+    size = qMin(size, SKEWED_MAX_SIZE);
+    bench.setGroup("skewed");
+    bench.setSize(size);
+    qint64 bytes = qint64(size) * sizeof(quint32);
+    QVector<quint32> expected(size);
+    QVector<quint32> output(size);
+    quint32 *out = output.data();
+
+    for (int i = 0; i < size; i++)
+        expected[i] = skewedWork(i, size);
+
+    auto work = [out, size] (const Range &chunk) {
+        for (int i: chunk)
+            out[i] = skewedWork(i, size);
+    };
+
+    bench.run("serial", bytes, [&] () {
+        work(Range(size));
+
+        return output == expected;
+    });
+
+    bench.run("staticSplit", bytes, [&] () {
+        QVector<Range> blocks =
+                Range(size).split(QThreadPool::globalInstance()->maxThreadCount());
+        QtConcurrent::blockingMap(blocks, work);
+
+        return output == expected;
+    });
+
+    bench.run("parallelFor", bytes, [&] () {
+        parallelFor(Range(size), work);
+
+        return output == expected;
+    });
+
+    bench.run("workStealingFor", bytes, [&] () {
+        workStealingFor(Range(size), work);
+
+        return output == expected;
+    });
+}
+
+// Sums a buffer initialized by the main thread with parallelFor(), and a
+// buffer first touched by the workers with affinityFor(), which on NUMA
+// machines keeps every block in the memory of the node that reads it.
+static void benchAffinity(Benchmark &bench, int size)
+{
+    bench.setGroup("affinity");
+    qint64 bytes = qint64(size) * sizeof(quint32);
+
+    auto init = [] (int i) {
+        return quint32(i) & 0x7f;
+    };
+
+    quint32 *serial = new quint32[size];
+
+    for (int i = 0; i < size; i++)
+        serial[i] = init(i);
+
+    quint32 *local = affinityFirstTouch<quint32>(size, init);
+    quint64 expected = 0;
+
+    for (int i = 0; i < size; i++)
+        expected += serial[i];
+
+    bench.run("serialInit+parallelFor", bytes, [&] () {
+        QAtomicInteger<quint64> sum(0);
+
+        parallelFor(Range(size), [serial, &sum] (const Range &chunk) {
+            quint64 chunkSum = 0;
+
+            for (int i: chunk)
+                chunkSum += serial[i];
+
+            sum.fetchAndAddRelaxed(chunkSum);
+        });
+
+        return sum.load() == expected;
+    });
+
+    bench.run("firstTouch+affinityFor", bytes, [&] () {
+        QAtomicInteger<quint64> sum(0);
+
+        affinityFor(Range(size), [local, &sum] (const Range &block) {
+            quint64 blockSum = 0;
+
+            for (int i: block)
+                blockSum += local[i];
+
+            sum.fetchAndAddRelaxed(blockSum);
+        });
+
+        return sum.load() == expected;
+    });
+
+    // Every block should start in a page of its worker's node, when the page
+    // node can be queried.
+    bench.run("placement", 0, [&] () {
+        QVector<Range> blocks =
+                Range(size).split(QThreadPool::globalInstance()->maxThreadCount());
+
+        for (int i = 0; i < blocks.size(); i++) {
+            int node = affinityPageNode(local + blocks[i].start());
+
+            if (node >= 0 && node != affinityWorkerNode(i, blocks.size()))
+                return false;
+        }
+
+        return true;
+    });
+
+    delete [] serial;
+    delete [] local;
+}
+
+// Every chunk produces a buffer that a slow consumer (STREAM_CONSUMER_DELAY
+// microseconds per chunk) sums and releases. Processing every chunk before
+// consuming keeps all the buffers alive at once, streaming them must never
+// hold more than STREAM_WINDOW.
+static void benchStream(Benchmark &bench,
+                        const QVector<quint32> &buffer,
+                        int size)
+{
+    bench.setGroup("stream");
+    const quint32 *in = buffer.constData();
+    qint64 bytes = qint64(size) * sizeof(quint32);
+    Range range(size);
+    quint64 expected = 0;
+
+    for (int i = 0; i < size; i++)
+        expected += in[i];
+
+    auto produce = [in] (const Range &chunk) {
+        QVector<quint32> *values = new QVector<quint32>(int(chunk.size()));
+
+        for (int i = 0; i < values->size(); i++)
+            (*values)[i] = in[chunk.start() + i];
+
+        return values;
+    };
+
+    auto consume = [] (QVector<quint32> *values, quint64 *sum) {
+        for (quint32 value: *values)
+            *sum += value;
+
+        delete values;
+        QThread::usleep(STREAM_CONSUMER_DELAY);
+    };
+
+    bench.run("parallelFor+consume", bytes, [&] () {
+        QVector<Range> chunks = range.chunks(STREAM_GRAIN);
+        QVector<QVector<quint32> *> buffers(chunks.size());
+
+        parallelFor(Range(chunks.size()), 1, [&] (const Range &indexes) {
+            for (int i: indexes)
+                buffers[i] = produce(chunks[i]);
+        });
+
+        quint64 sum = 0;
+
+        for (QVector<quint32> *values: buffers)
+            consume(values, &sum);
+
+        return sum == expected;
+    });
+
+    bench.run("streamFor", bytes, [&] () {
+        QVector<QVector<quint32> *> slots(STREAM_WINDOW);
+        QAtomicInt live(0);
+        int maxLive = 0;
+        quint64 sum = 0;
+
+        RangeStream stream =
+                streamFor(range,
+                          STREAM_GRAIN,
+                          STREAM_WINDOW,
+                          [&] (qint64 index, const Range &chunk) {
+            slots[int(index % STREAM_WINDOW)] = produce(chunk);
+            live.ref();
+        },
+                          [&] (qint64 index, const Range &) {
+            maxLive = qMax(maxLive, live.load());
+            consume(slots[int(index % STREAM_WINDOW)], &sum);
+            live.deref();
+        });
+
+        stream.waitForFinished();
+
+        return sum == expected
+               && maxLive <= STREAM_WINDOW
+               && stream.maxInFlight() <= STREAM_WINDOW;
+    });
+}
+
+// Reduces a synthetic index space far bigger than 2^32 in chunks, the sum of
+// the indexes catches any index lost or repeated at the chunk boundaries.
+static void benchStress(Benchmark &bench)
+{
+    bench.setGroup("stress");
+    bench.setSize(STRESS_SIZE);
+    BasicRange<qint64> range(0, STRESS_SIZE);
+    quint64 n = quint64(STRESS_SIZE);
+
+    // n * (n - 1) / 2 modulo 2^64, halving the even factor first.
+    quint64 expected = n & 0x1? n * ((n - 1) / 2): (n / 2) * (n - 1);
+    qint64 bytes = STRESS_SIZE * qint64(sizeof(qint64));
+
+    auto add = [] (quint64 a, quint64 b) {
+        return a + b;
+    };
+
+    bench.run("parallelFor", bytes, [&] () {
+        QAtomicInteger<quint64> sum(0);
+
+        parallelFor(range, [&sum] (const BasicRange<qint64> &chunk) {
+            quint64 chunkSum = 0;
+
+            for (qint64 i = chunk.start(); i < chunk.stop(); i++)
+                chunkSum += quint64(i);
+
+            sum.fetchAndAddRelaxed(chunkSum);
+        });
+
+        return sum.load() == expected;
+    });
+
+    bench.run("parallelReduce", bytes, [&] () {
+        quint64 sum = parallelReduce(range, quint64(0), [] (qint64 i) {
+            return quint64(i);
+        }, add);
+
+        return sum == expected;
+    });
+}
+
+// Fills file with bytes bytes of pseudo random quint32 values and returns
+// their sum in sum.
+static bool writeMappedFile(QTemporaryFile *file, qint64 bytes, quint32 *sum)
+{
+    if (!file->open()) {
+        qWarning() << "Can't create a temporary file" << file->errorString();
+
+        return false;
+    }
+
+    QVector<quint32> values(MAPPED_WRITE_SIZE);
+    qint64 size = bytes / qint64(sizeof(quint32));
+    quint32 seed = 1;
+    *sum = 0;
+
+    for (qint64 i = 0; i < size; i += values.size()) {
+        int n = int(qMin<qint64>(values.size(), size - i));
+
+        for (int j = 0; j < n; j++) {
+            seed = 1664525u * seed + 1013904223u;
+            values[j] = seed >> 25;
+            *sum += values[j];
+        }
+
+        qint64 chunkBytes = n * qint64(sizeof(quint32));
+
+        if (file->write(reinterpret_cast<const char *>(values.constData()),
+                        chunkBytes) != chunkBytes) {
+            qWarning() << "Can't write" << file->fileName() << file->errorString();
+
+            return false;
+        }
+    }
+
+    return file->flush();
+}
+
+// Sums a file, bigger than the memory if asked so, through memory mapped
+// windows, and compares with the sum computed while writing it.
+static void benchMapped(Benchmark &bench,
+                        const QString &fileName,
+                        qint64 bytes,
+                        quint32 expected)
+{
+    bench.setGroup("mapped");
+    bench.setSize(bytes / qint64(sizeof(quint32)));
+
+    bench.run("serial", bytes, [&] () {
+        MappedReader reader(fileName);
+        quint32 sum = 0;
+
+        bool ok = reader.forEachWindow(sizeof(quint32),
+                                       [&sum] (qint64, const uchar *data, qint64 bytes) {
+            auto values = reinterpret_cast<const quint32 *>(data);
+            qint64 size = bytes / qint64(sizeof(quint32));
+
+            for (qint64 i = 0; i < size; i++)
+                sum += values[i];
+        });
+
+        return ok && sum == expected;
+    });
+
+    bench.run("mappedSum", bytes, [&] () {
+        quint32 sum = 0;
+
+        return mappedSum(fileName, &sum) && sum == expected;
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("range_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Compares the parallel strategies "
+                                     "over Range.");
+    parser.addHelpOption();
+    QCommandLineOption sizesOption("sizes",
+                                   "Comma separated list of buffer sizes.",
+                                   "sizes",
+                                   QString("%1,%2")
+                                       .arg(1 << 20)
+                                       .arg(BUFFERSIZE));
+    int idealThreads = QThread::idealThreadCount();
+    QCommandLineOption threadsOption("threads",
+                                     "Comma separated list of thread counts.",
+                                     "threads",
+                                     idealThreads > 1?
+                                         QString("1,%1").arg(idealThreads):
+                                         QString("1"));
+    QCommandLineOption warmupOption("warmup",
+                                    "Untimed runs before measuring.",
+                                    "n",
+                                    "2");
+    QCommandLineOption repetitionsOption("repetitions",
+                                         "Timed runs per strategy.",
+                                         "n",
+                                         "10");
+    QCommandLineOption filterOption("filter",
+                                    "Run only the strategies whose "
+                                    "group/name contains this text.",
+                                    "text");
+    QCommandLineOption stressOption("stress",
+                                    "Also reduce a synthetic range of 8 "
+                                    "billion indexes, it takes a while.");
+    QCommandLineOption mappedOption("mapped",
+                                    "Also sum a temporary file of this many "
+                                    "bytes through memory mapped windows.",
+                                    "bytes");
+    QCommandLineOption traceOption("trace",
+                                   "Record every task in the Chrome trace "
+                                   "event format, needs a build with "
+                                   "CONFIG+=range_trace.",
+                                   "file");
+    QCommandLineOption csvOption("csv", "Write results as CSV.", "file");
+    QCommandLineOption jsonOption("json", "Write results as JSON.", "file");
+    parser.addOption(sizesOption);
+    parser.addOption(threadsOption);
+    parser.addOption(warmupOption);
+    parser.addOption(repetitionsOption);
+    parser.addOption(filterOption);
+    parser.addOption(stressOption);
+    parser.addOption(mappedOption);
+    parser.addOption(traceOption);
+    parser.addOption(csvOption);
+    parser.addOption(jsonOption);
+    parser.process(app);
+
+    QList<qint64> sizes = parseList(parser.value(sizesOption));
+    QList<qint64> threads = parseList(parser.value(threadsOption));
+    Benchmark bench(parser.value(warmupOption).toInt(),
+                    parser.value(repetitionsOption).toInt());
+    bench.setFilter(parser.value(filterOption));
+
+    qint64 maxSize = 0;
+
+    for (qint64 size: sizes)
+        maxSize = qMax(maxSize, size);
+
+    QVector<quint32> buffer(int(qMin<qint64>(maxSize,
+                                             std::numeric_limits<int>::max())));
+
+    for (int i = 0; i < buffer.size(); i++)
+        buffer[i] = qrand() % 128;
+
+    QTemporaryFile mappedFile;
+    qint64 mappedBytes = parser.value(mappedOption).toLongLong();
+    quint32 mappedExpected = 0;
+
+    if (mappedBytes > 0 && !writeMappedFile(&mappedFile, mappedBytes, &mappedExpected))
+        return 1;
+
+    if (parser.isSet(traceOption) && !traceStart())
+        qWarning() << "Built without RANGE_TRACE, --trace ignored";
+
+    int defaultThreads = QThreadPool::globalInstance()->maxThreadCount();
+    bool valid = true;
+
+    for (qint64 nThreads: threads) {
+        QThreadPool::globalInstance()->setMaxThreadCount(int(nThreads));
+        bench.setThreads(int(nThreads));
+
+        for (qint64 size: sizes) {
+            bench.setSize(size);
+            int n = int(qMin<qint64>(size, buffer.size()));
+            benchSum(bench, buffer, n);
+            benchKernels(bench, n);
+            benchReduction(bench, buffer, n);
+            benchPairwise(bench, buffer, n);
+            benchHistogram(bench, buffer, n);
+            benchScan(bench, buffer, n);
+            benchFill(bench, n);
+            benchElementwise(bench, buffer, n);
+            benchPipeline(bench, buffer, n);
+            benchMembership(bench, n);
+            benchIndexSet(bench, buffer, n);
+            benchAffinity(bench, n);
+            benchStream(bench, buffer, n);
+            benchStencil(bench, buffer, n);
+            benchCurve(bench, buffer, n);
+            benchSkewed(bench, n);
+        }
+
+        if (parser.isSet(stressOption))
+            benchStress(bench);
+
+        if (mappedBytes > 0)
+            benchMapped(bench, mappedFile.fileName(), mappedBytes, mappedExpected);
+    }
+
+    QThreadPool::globalInstance()->setMaxThreadCount(defaultThreads);
+
+    if (traceIsRecording()) {
+        traceStop();
+        traceWriteChrome(parser.value(traceOption));
+    }
+
+    for (const BenchmarkResult &result: bench.results())
+        valid &= result.valid;
+
+    if (parser.isSet(csvOption))
+        bench.writeCsv(parser.value(csvOption));
+
+    if (parser.isSet(jsonOption))
+        bench.writeJson(parser.value(jsonOption));
+
+    return valid? 0: 1;
+}
@@ -0,0 +1,73 @@
+# QtRangeExample, Implementation of range iterator in Qt, and usage example
+# with QtConcurrent.
+# Copyright (C) 2015  Gonzalo Exequiel Pedone
+#
+# QtRangeExample is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# QtRangeExample is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+#
+# Email   : hipersayan DOT x AT gmail DOT com
+# Web-Site: http://github.com/hipersayanX/QtRangeExample
+
+QT += core concurrent
+QT -= gui
+
+TARGET = range_bench
+CONFIG += console c++14
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+# libnuma is optional, without it the NUMA topology is read from sysfs.
+unix:exists(/usr/include/numa.h) {
+    DEFINES += HAVE_LIBNUMA
+    LIBS += -lnuma
+}
+
+# qmake CONFIG+=range_trace records every task the parallel loops run, see
+# trace.h.
+range_trace: DEFINES += RANGE_TRACE
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../affinity.cpp \
+    ../curve.cpp \
+    ../indexset.cpp \
+    ../kernels.cpp \
+    ../mapped.cpp \
+    ../parallel.cpp \
+    ../reduction.cpp \
+    ../stream.cpp \
+    ../trace.cpp \
+    ../workstealing.cpp \
+    benchmark.cpp \
+    main.cpp
+
+HEADERS += \
+    ../affinity.h \
+    ../curve.h \
+    ../histogram.h \
+    ../indexset.h \
+    ../kernels.h \
+    ../mapped.h \
+    ../pairwise.h \
+    ../parallel.h \
+    ../pipeline.h \
+    ../range.h \
+    ../rangend.h \
+    ../reduction.h \
+    ../scan.h \
+    ../stream.h \
+    ../trace.h \
+    ../workstealing.h \
+    benchmark.h
@@ -0,0 +1,386 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#include "curve.h"
+
+#if defined(Q_PROCESSOR_X86_64) && (defined(Q_CC_GNU) || defined(Q_CC_CLANG))
+#define CURVE_BMI2
+#include <immintrin.h>
+#endif
+
+#define CURVE_ROW_BITS Q_UINT64_C(0xaaaaaaaaaaaaaaaa)
+#define CURVE_COL_BITS Q_UINT64_C(0x5555555555555555)
+#define CURVE_HILBERT_STATES 4
+#define CURVE_LEAF_POINTS (CURVE_LEAF_SIZE * CURVE_LEAF_SIZE)
+
+// A Morton curve visits the quadrants row by row. A Hilbert curve enters
+// every quadrant where the previous one left, the first and the last ones
+// transposed so that it stays continuous.
+static const CurveQuadrant mortonQuadrants[4] = {
+    {0, 0, 0}, {0, 1, 0}, {1, 0, 0}, {1, 1, 0}
+};
+
+static const CurveQuadrant hilbertQuadrants[CURVE_HILBERT_STATES][4] = {
+    {{0, 0, 1}, {0, 1, 0}, {1, 1, 0}, {1, 0, 3}},
+    {{0, 0, 0}, {1, 0, 1}, {1, 1, 1}, {0, 1, 2}},
+    {{1, 1, 3}, {1, 0, 2}, {0, 0, 2}, {0, 1, 1}},
+    {{1, 1, 2}, {0, 1, 3}, {0, 0, 3}, {1, 0, 0}}
+};
+
+struct CurveLeaves
+{
+    quint8 morton[2 * CURVE_LEAF_POINTS];
+    quint8 hilbert[CURVE_HILBERT_STATES][2 * CURVE_LEAF_POINTS];
+};
+
+static void fillLeaf(CurveOrder order,
+                     int state,
+                     int level,
+                     int row,
+                     int col,
+                     quint8 **leaf)
+{
+    if (level == 0) {
+        *(*leaf)++ = quint8(row);
+        *(*leaf)++ = quint8(col);
+
+        return;
+    }
+
+    const CurveQuadrant *quadrants = curveQuadrants(order, state);
+    int half = 1 << (level - 1);
+
+    for (int i = 0; i < 4; i++)
+        fillLeaf(order,
+                 quadrants[i].state,
+                 level - 1,
+                 row + quadrants[i].row * half,
+                 col + quadrants[i].col * half,
+                 leaf);
+}
+
+static CurveLeaves makeLeaves()
+{
+    CurveLeaves leaves;
+    quint8 *leaf = leaves.morton;
+    fillLeaf(CurveOrderMorton, 0, CURVE_LEAF_BITS, 0, 0, &leaf);
+
+    for (int state = 0; state < CURVE_HILBERT_STATES; state++) {
+        leaf = leaves.hilbert[state];
+        fillLeaf(CurveOrderHilbert, state, CURVE_LEAF_BITS, 0, 0, &leaf);
+    }
+
+    return leaves;
+}
+
+static const CurveLeaves &leaves()
+{
+    static const CurveLeaves leaves = makeLeaves();
+
+    return leaves;
+}
+
+static quint64 mortonEncodeScalar(quint32 row, quint32 col)
+{
+    quint64 code = 0;
+
+    for (int bit = 0; bit < 32; bit++)
+        code |= quint64(row >> bit & 0x1) << (2 * bit + 1)
+              | quint64(col >> bit & 0x1) << (2 * bit);
+
+    return code;
+}
+
+static void mortonDecodeScalar(quint64 code, quint32 *row, quint32 *col)
+{
+    *row = 0;
+    *col = 0;
+
+    for (int bit = 0; bit < 32; bit++) {
+        *row |= quint32(code >> (2 * bit + 1) & 0x1) << bit;
+        *col |= quint32(code >> (2 * bit) & 0x1) << bit;
+    }
+}
+
+#ifdef CURVE_BMI2
+__attribute__((target("bmi2")))
+static quint64 mortonEncodeBmi2(quint32 row, quint32 col)
+{
+    return _pdep_u64(row, CURVE_ROW_BITS) | _pdep_u64(col, CURVE_COL_BITS);
+}
+
+__attribute__((target("bmi2")))
+static void mortonDecodeBmi2(quint64 code, quint32 *row, quint32 *col)
+{
+    *row = quint32(_pext_u64(code, CURVE_ROW_BITS));
+    *col = quint32(_pext_u64(code, CURVE_COL_BITS));
+}
+#endif
+
+static bool hasBmi2()
+{
+#ifdef CURVE_BMI2
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports("bmi2");
+#else
+    return false;
+#endif
+}
+
+static const bool bmi2 = hasBmi2();
+
+#ifdef CURVE_BMI2
+static quint64 (*mortonEncode)(quint32 row, quint32 col) =
+        bmi2? mortonEncodeBmi2: mortonEncodeScalar;
+static void (*mortonDecode)(quint64 code, quint32 *row, quint32 *col) =
+        bmi2? mortonDecodeBmi2: mortonDecodeScalar;
+#else
+static quint64 (*mortonEncode)(quint32 row, quint32 col) = mortonEncodeScalar;
+static void (*mortonDecode)(quint64 code, quint32 *row, quint32 *col) =
+        mortonDecodeScalar;
+#endif
+
+// The number of points of the size x size square at (row, col) that are in
+// [0, height) x [0, width).
+static inline qint64 overlap(qint64 row,
+                             qint64 col,
+                             qint64 size,
+                             qint64 height,
+                             qint64 width)
+{
+    qint64 rows = qMin(row + size, height) - row;
+    qint64 cols = qMin(col + size, width) - col;
+
+    return rows > 0 && cols > 0? rows * cols: 0;
+}
+
+const CurveQuadrant *curveQuadrants(CurveOrder order, int state)
+{
+    return order == CurveOrderMorton? mortonQuadrants: hilbertQuadrants[state];
+}
+
+const quint8 *curveLeaf(CurveOrder order, int state)
+{
+    return order == CurveOrderMorton?
+                leaves().morton:
+                leaves().hilbert[state];
+}
+
+quint64 curveEncode(CurveOrder order, int bits, quint32 row, quint32 col)
+{
+    // Morton codes don't depend on the size of the square.
+    if (order == CurveOrderMorton)
+        return mortonEncode(row, col);
+
+    quint64 code = 0;
+    int state = 0;
+
+    for (int level = bits - 1; level >= 0; level--) {
+        int rowBit = row >> level & 0x1;
+        int colBit = col >> level & 0x1;
+        const CurveQuadrant *quadrants = hilbertQuadrants[state];
+        int i = 0;
+
+        while (quadrants[i].row != rowBit || quadrants[i].col != colBit)
+            i++;
+
+        code = code << 2 | quint64(i);
+        state = quadrants[i].state;
+    }
+
+    return code;
+}
+
+void curveDecode(CurveOrder order,
+                 int bits,
+                 quint64 code,
+                 quint32 *row,
+                 quint32 *col)
+{
+    if (order == CurveOrderMorton) {
+        mortonDecode(code, row, col);
+
+        return;
+    }
+
+    *row = 0;
+    *col = 0;
+    int state = 0;
+
+    for (int level = bits - 1; level >= 0; level--) {
+        const CurveQuadrant &quadrant =
+                hilbertQuadrants[state][code >> (2 * level) & 0x3];
+        *row |= quint32(quadrant.row) << level;
+        *col |= quint32(quadrant.col) << level;
+        state = quadrant.state;
+    }
+}
+
+bool curveHasBmi2()
+{
+    return bmi2;
+}
+
+RangeCurve::RangeCurve():
+    m_order(CurveOrderHilbert),
+    m_bits(0),
+    m_start(0),
+    m_stop(0)
+{
+}
+
+RangeCurve::RangeCurve(const Range2D &range, CurveOrder order):
+    m_range(range),
+    m_order(order),
+    m_bits(0),
+    m_start(0)
+{
+    qint64 side = qMax(range.axis(0).size(), range.axis(1).size());
+
+    while ((qint64(1) << this->m_bits) < side)
+        this->m_bits++;
+
+    Q_ASSERT_X(this->m_bits <= CURVE_MAX_BITS,
+               "RangeCurve",
+               "the range is too big for the curve");
+    this->m_stop = range.isEmpty()? 0: quint64(1) << (2 * this->m_bits);
+}
+
+int RangeCurve::bits() const
+{
+    return this->m_bits;
+}
+
+bool RangeCurve::isEmpty() const
+{
+    return this->size() < 1;
+}
+
+CurveOrder RangeCurve::order() const
+{
+    return this->m_order;
+}
+
+const Range2D &RangeCurve::range() const
+{
+    return this->m_range;
+}
+
+qint64 RangeCurve::size() const
+{
+    if (this->m_start >= this->m_stop)
+        return 0;
+
+    return this->countBefore(this->m_stop) - this->countBefore(this->m_start);
+}
+
+QVector<RangeCurve> RangeCurve::split(int n) const
+{
+    qint64 size = this->size();
+    n = int(qBound<qint64>(1, n, qMax<qint64>(size, 1)));
+    qint64 before = this->countBefore(this->m_start);
+    QVector<RangeCurve> parts(n, *this);
+
+    for (int i = 1; i < n; i++) {
+        qint64 target = before + i * (size / n) + qMin<qint64>(i, size % n);
+
+        // Every position adds at most a point, so the first one with target
+        // points before it has exactly target points before it.
+        quint64 first = parts[i - 1].m_start;
+        quint64 last = this->m_stop;
+
+        while (first < last) {
+            quint64 middle = first + (last - first) / 2;
+
+            if (this->countBefore(middle) < target)
+                first = middle + 1;
+            else
+                last = middle;
+        }
+
+        parts[i - 1].m_stop = first;
+        parts[i].m_start = first;
+    }
+
+    return parts;
+}
+
+quint64 RangeCurve::start() const
+{
+    return this->m_start;
+}
+
+quint64 RangeCurve::stop() const
+{
+    return this->m_stop;
+}
+
+// The number of points of the range at curve positions before code. The curve
+// is descended towards code, adding the points of the quadrants it leaves
+// behind.
+qint64 RangeCurve::countBefore(quint64 code) const
+{
+    qint64 height = this->m_range.axis(0).size();
+    qint64 width = this->m_range.axis(1).size();
+
+    if (code >= quint64(1) << (2 * this->m_bits))
+        return height * width;
+
+    qint64 count = 0;
+    qint64 row = 0;
+    qint64 col = 0;
+    int state = 0;
+
+    for (int level = this->m_bits - 1; level >= 0; level--) {
+        const CurveQuadrant *quadrants = curveQuadrants(this->m_order, state);
+        int quadrant = int(code >> (2 * level) & 0x3);
+        qint64 half = qint64(1) << level;
+
+        for (int i = 0; i < quadrant; i++)
+            count += overlap(row + quadrants[i].row * half,
+                             col + quadrants[i].col * half,
+                             half,
+                             height,
+                             width);
+
+        row += quadrants[quadrant].row * half;
+        col += quadrants[quadrant].col * half;
+        state = quadrants[quadrant].state;
+    }
+
+    return count;
+}
+
+QDebug operator <<(QDebug debug, const RangeCurve &curve)
+{
+    debug.nospace() << "RangeCurve("
+                    << curve.range()
+                    << ", "
+                    << (curve.order() == CurveOrderMorton? "Morton": "Hilbert")
+                    << ", "
+                    << curve.start()
+                    << ".."
+                    << curve.stop()
+                    << ")";
+
+    return debug.space();
+}
@@ -0,0 +1,223 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef CURVE_H
+#define CURVE_H
+
+#include "rangend.h"
+
+// Bits of the side of the blocks walked with a lookup table, instead of
+// descending the curve down to every point.
+#define CURVE_LEAF_BITS 3
+#define CURVE_LEAF_SIZE (1 << CURVE_LEAF_BITS)
+
+// The biggest side of a RangeCurve, so codes fit in 62 bits.
+#define CURVE_MAX_BITS 31
+
+enum CurveOrder
+{
+    CurveOrderMorton,
+    CurveOrderHilbert
+};
+
+// A quadrant of a square of the curve: its position in the square, and the
+// state of the curve inside of it.
+struct CurveQuadrant
+{
+    quint8 row;
+    quint8 col;
+    quint8 state;
+};
+
+// The 4 quadrants of a square in curve order, for the given state of the
+// curve. Morton curves have a single state, Hilbert curves rotate and mirror
+// the quadrants, with 4 states.
+const CurveQuadrant *curveQuadrants(CurveOrder order, int state);
+
+// The row and col offsets of the CURVE_LEAF_SIZE x CURVE_LEAF_SIZE points
+// of a block in curve order, as consecutive pairs.
+const quint8 *curveLeaf(CurveOrder order, int state);
+
+// Position of (row, col) along the curve that covers a square of
+// 2^bits x 2^bits points, and back. Morton codes are computed with the BMI2
+// pdep and pext instructions when the CPU has them.
+quint64 curveEncode(CurveOrder order, int bits, quint32 row, quint32 col);
+void curveDecode(CurveOrder order,
+                 int bits,
+                 quint64 code,
+                 quint32 *row,
+                 quint32 *col);
+
+// Whether curveEncode() and curveDecode() use BMI2.
+bool curveHasBmi2();
+
+// Walks a Range2D along a space filling curve instead of row by row, so
+// points close on the walk are close in both axes, and the rows and columns
+// of a buffer indexed by them are touched in blocks that fit in cache.
+// The curve covers the smallest power of two square that holds the range,
+// and a RangeCurve is a segment of consecutive curve positions. Whole
+// quadrants out of the range are skipped, so ranges of any shape are walked
+// without visiting the padding.
+class RangeCurve
+{
+    public:
+        RangeCurve();
+        RangeCurve(const Range2D &range, CurveOrder order=CurveOrderHilbert);
+
+        int bits() const;
+
+        // Calls function(const Range2D::Index &index) for every point of the
+        // segment, in curve order.
+        template <typename Function>
+        void forEach(Function function) const;
+        bool isEmpty() const;
+        CurveOrder order() const;
+        const Range2D &range() const;
+        qint64 size() const;
+
+        // Cuts the segment in n consecutive segments of the curve, with
+        // sizes differing at most by one point.
+        QVector<RangeCurve> split(int n) const;
+
+        // The segment covers the curve positions in [start, stop).
+        quint64 start() const;
+        quint64 stop() const;
+
+    private:
+        Range2D m_range;
+        CurveOrder m_order;
+        int m_bits;
+        quint64 m_start;
+        quint64 m_stop;
+
+        qint64 countBefore(quint64 code) const;
+        template <typename Function>
+        void walk(Function &function,
+                  Range2D::Index &index,
+                  int state,
+                  int level,
+                  quint64 code,
+                  qint64 row,
+                  qint64 col) const;
+};
+
+template <typename Function>
+void RangeCurve::forEach(Function function) const
+{
+    if (this->isEmpty())
+        return;
+
+    Range2D::Index index;
+    this->walk(function, index, 0, this->m_bits, 0, 0, 0);
+}
+
+template <typename Function>
+void RangeCurve::walk(Function &function,
+                      Range2D::Index &index,
+                      int state,
+                      int level,
+                      quint64 code,
+                      qint64 row,
+                      qint64 col) const
+{
+    const Range2D::Axis &rows = this->m_range.axis(0);
+    const Range2D::Axis &cols = this->m_range.axis(1);
+    quint64 codes = quint64(1) << (2 * level);
+    qint64 side = qint64(1) << level;
+
+    if (code >= this->m_stop
+        || code + codes <= this->m_start
+        || row >= rows.size()
+        || col >= cols.size())
+        return;
+
+    if (level == 0) {
+        index[0] = rows.at(row);
+        index[1] = cols.at(col);
+        function(const_cast<const Range2D::Index &>(index));
+
+        return;
+    }
+
+    if (level == CURVE_LEAF_BITS
+        && code >= this->m_start
+        && code + codes <= this->m_stop
+        && row + side <= rows.size()
+        && col + side <= cols.size()) {
+        const quint8 *leaf = curveLeaf(this->m_order, state);
+        RangeType rowValues[CURVE_LEAF_SIZE];
+        RangeType colValues[CURVE_LEAF_SIZE];
+
+        for (int i = 0; i < CURVE_LEAF_SIZE; i++) {
+            rowValues[i] = rows.at(row + i);
+            colValues[i] = cols.at(col + i);
+        }
+
+        for (int i = 0; i < CURVE_LEAF_SIZE * CURVE_LEAF_SIZE; i++) {
+            const Range2D::Index point {rowValues[leaf[2 * i]],
+                                        colValues[leaf[2 * i + 1]]};
+            function(point);
+        }
+
+        return;
+    }
+
+    const CurveQuadrant *quadrants = curveQuadrants(this->m_order, state);
+    qint64 half = side / 2;
+
+    for (int i = 0; i < 4; i++)
+        this->walk(function,
+                   index,
+                   quadrants[i].state,
+                   level - 1,
+                   code + quint64(i) * (codes / 4),
+                   row + quadrants[i].row * half,
+                   col + quadrants[i].col * half);
+}
+
+QDebug operator <<(QDebug debug, const RangeCurve &curve);
+
+// Runs function(const RangeCurve &segment) over consecutive segments of curve
+// in the global thread pool, so every worker walks a compact region of the
+// range.
+template <typename Function>
+void parallelFor(const RangeCurve &curve, Function function)
+{
+    qint64 size = curve.size();
+    qint64 grain = parallelGrain(size);
+    QVector<RangeCurve> segments = curve.split(int((size + grain - 1) / grain));
+
+    if (segments.size() < 2) {
+        for (const RangeCurve &segment: segments) {
+            TRACE_SCOPE("parallelFor/curve", segment.size());
+            function(segment);
+        }
+
+        return;
+    }
+
+    QtConcurrent::blockingMap(segments, [&function] (RangeCurve &segment) {
+        TRACE_SCOPE("parallelFor/curve", segment.size());
+        function(segment);
+    });
+}
+
+#endif // CURVE_H
@@ -0,0 +1,168 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include "parallel.h"
+#include "reduction.h"
+
+// Up to this number of bins every thread keeps HISTOGRAM_REPLICAS copies of
+// its bins, and consecutive elements go to different copies.
+#define HISTOGRAM_REPLICA_BINS 256
+#define HISTOGRAM_REPLICAS 4
+
+// Below this number of bins the private bins are merged in the calling thread.
+#define HISTOGRAM_PARALLEL_MERGE_BINS 4096
+
+// Sums value(index) per key(index) over range in the global thread pool, and
+// returns the sum of every key in [0, bins). Keys out of [0, bins) are
+// skipped.
+// Every thread adds its block of the range into private bins, padded to
+// REDUCTION_CACHE_LINE so no two threads write in the same cache line, and
+// the private bins are summed once at the end, split by bin between the
+// threads for big bin counts. So threads never contend on a bin and the work
+// scales with the number of cores.
+// With few bins, most consecutive elements hit the same few bins, and every
+// addition waits for the previous one to the same bin. Rotating between
+// HISTOGRAM_REPLICAS copies of the bins keeps those additions independent.
+// The private bins live in the scratch of context, pass one to reuse them
+// between calls.
+template <typename T,
+          typename KeyFunction,
+          typename ValueFunction,
+          typename R>
+QVector<T> parallelReduceByKey(const BasicRange<R> &range,
+                               KeyFunction key,
+                               ValueFunction value,
+                               int bins,
+                               ReductionContext *context=nullptr)
+{
+    typedef typename BasicRange<R>::size_type size_type;
+
+    struct Block
+    {
+        BasicRange<R> range;
+        T *bins;
+    };
+
+    bins = qMax(bins, 0);
+    QVector<T> result(bins, T(0));
+
+    if (bins < 1 || range.isEmpty())
+        return result;
+
+    ReductionContext localContext;
+
+    if (!context)
+        context = &localContext;
+
+    int replicas = bins <= HISTOGRAM_REPLICA_BINS? HISTOGRAM_REPLICAS: 1;
+
+    // Every copy of the bins starts in its own cache line.
+    int lineSize = qMax<int>(1, REDUCTION_CACHE_LINE / sizeof(T));
+    qint64 stride = (qint64(bins) + lineSize - 1) / lineSize * lineSize;
+    QVector<BasicRange<R>> ranges =
+            range.split(QThreadPool::globalInstance()->maxThreadCount());
+    int n = ranges.size();
+    T *privateBins = context->scratch<T>(0, n * replicas * stride);
+    QVector<Block> blocks(n);
+
+    for (int i = 0; i < n; i++) {
+        blocks[i].range = ranges[i];
+        blocks[i].bins = privateBins + i * replicas * stride;
+    }
+
+    auto runBlock = [&key, &value, bins, replicas, stride] (Block &block) {
+        TRACE_SCOPE("parallelReduceByKey", block.range.size());
+
+        // Cleared by the thread that uses them, so on NUMA machines the
+        // pages land in its node.
+        std::fill(block.bins, block.bins + replicas * stride, T(0));
+
+        R start = block.range.start();
+        R step = block.range.step();
+        size_type size = block.range.size();
+        size_type i = 0;
+
+        auto add = [&] (T *copy, size_type i) {
+            R index = RangeTraits<R>::at(start, step, i);
+            // Widen before comparing so 64 bits keys aren't truncated into
+            // the bins, negative keys wrap past bins.
+            quint64 k = quint64(qint64(key(index)));
+
+            if (k < quint64(bins))
+                copy[k] += value(index);
+        };
+
+        if (replicas > 1)
+            for (; i + HISTOGRAM_REPLICAS <= size; i += HISTOGRAM_REPLICAS)
+                for (int j = 0; j < HISTOGRAM_REPLICAS; j++)
+                    add(block.bins + j * stride, i + j);
+
+        for (; i < size; i++)
+            add(block.bins, i);
+    };
+
+    if (n < 2)
+        runBlock(blocks[0]);
+    else
+        QtConcurrent::blockingMap(blocks, runBlock);
+
+    T *out = result.data();
+    int copies = n * replicas;
+
+    auto merge = [out, privateBins, copies, stride] (const Range &chunk) {
+        TRACE_SCOPE("parallelReduceByKey/merge", chunk.size());
+
+        for (int copy = 0; copy < copies; copy++) {
+            const T *bins = privateBins + copy * stride;
+
+            for (int bin: chunk)
+                out[bin] += bins[bin];
+        }
+    };
+
+    if (bins < HISTOGRAM_PARALLEL_MERGE_BINS)
+        merge(Range(bins));
+    else
+        parallelFor(Range(bins), merge);
+
+    return result;
+}
+
+// Counts the elements of range per key(index), see parallelReduceByKey().
+template <typename KeyFunction, typename R>
+QVector<qint64> parallelHistogram(const BasicRange<R> &range,
+                                  KeyFunction key,
+                                  int bins,
+                                  ReductionContext *context=nullptr)
+{
+    return parallelReduceByKey<qint64>(range,
+                                       key,
+                                       [] (R) {
+                                           return qint64(1);
+                                       },
+                                       bins,
+                                       context);
+}
+
+#endif // HISTOGRAM_H
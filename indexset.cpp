@@ -0,0 +1,969 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#include "indexset.h"
+
+#define INDEXSET_CONTAINER_SIZE (Q_INT64_C(1) << 16)
+#define INDEXSET_VALUE_LIMIT (Q_INT64_C(1) << 32)
+#define INDEXSET_BITMAP_BYTES (INDEXSET_BITMAP_WORDS * qint64(sizeof(quint64)))
+#define INDEXSET_KIND_RUNS 0
+#define INDEXSET_KIND_ARRAY 1
+#define INDEXSET_KIND_BITMAP 2
+
+// Indexes are stored with the sign bit flipped, so the unsigned order of the
+// stored values is the order of the indexes.
+inline quint32 toStored(int value)
+{
+    return quint32(value) ^ 0x80000000u;
+}
+
+inline int fromStored(quint32 value)
+{
+    return int(value ^ 0x80000000u);
+}
+
+static void setBits(quint64 *bitmap, int first, int last)
+{
+    int firstWord = first >> 6;
+    int lastWord = last >> 6;
+    quint64 firstMask = ~quint64(0) << (first & 0x3f);
+    quint64 lastMask = ~quint64(0) >> (63 - (last & 0x3f));
+
+    if (firstWord == lastWord) {
+        bitmap[firstWord] |= firstMask & lastMask;
+
+        return;
+    }
+
+    bitmap[firstWord] |= firstMask;
+
+    for (int word = firstWord + 1; word < lastWord; word++)
+        bitmap[word] = ~quint64(0);
+
+    bitmap[lastWord] |= lastMask;
+}
+
+// Number of runs of set bits, every run starts at a set bit with the
+// previous one unset.
+static int bitmapRunCount(const quint64 *bitmap)
+{
+    int runs = 0;
+    quint64 carry = 0;
+
+    for (int word = 0; word < INDEXSET_BITMAP_WORDS; word++) {
+        quint64 bits = bitmap[word];
+        runs += qPopulationCount(bits & ~(bits << 1 | carry));
+        carry = bits >> 63;
+    }
+
+    return runs;
+}
+
+// Appends the run [first, last] to runs, merging it with the last run if they
+// overlap or touch. Runs must be appended sorted by first.
+static void appendRun(QVector<quint16> &runs, int first, int last)
+{
+    if (!runs.isEmpty() && first <= runs.last() + 1) {
+        if (last > runs.last())
+            runs.last() = quint16(last);
+
+        return;
+    }
+
+    runs << quint16(first) << quint16(last);
+}
+
+template <typename Container>
+static QVector<quint16> containerRuns(const Container &container)
+{
+    if (!container.array.isEmpty()) {
+        QVector<quint16> runs;
+
+        for (quint16 value: container.array)
+            appendRun(runs, value, value);
+
+        return runs;
+    }
+
+    if (container.bitmap.isEmpty())
+        return container.runs;
+
+    QVector<quint16> runs;
+    int first = -1;
+
+    for (int word = 0; word < INDEXSET_BITMAP_WORDS; word++) {
+        quint64 bits = container.bitmap[word];
+
+        // Skip the words that don't end or start a run.
+        if (first < 0? !bits: !~bits)
+            continue;
+
+        for (int bit = 0; bit < 64; bit++) {
+            bool set = bits >> bit & 0x1;
+
+            if (set && first < 0) {
+                first = word << 6 | bit;
+            } else if (!set && first >= 0) {
+                runs << quint16(first) << quint16((word << 6 | bit) - 1);
+                first = -1;
+            }
+        }
+    }
+
+    if (first >= 0)
+        runs << quint16(first) << quint16(INDEXSET_CONTAINER_SIZE - 1);
+
+    return runs;
+}
+
+template <typename Container>
+static QVector<quint16> containerArray(const Container &container)
+{
+    if (!container.array.isEmpty())
+        return container.array;
+
+    QVector<quint16> array;
+    array.reserve(container.count);
+
+    if (container.bitmap.isEmpty()) {
+        for (int i = 0; i < container.runs.size(); i += 2)
+            for (int value = container.runs[i]; value <= container.runs[i + 1]; value++)
+                array << quint16(value);
+    } else {
+        for (int word = 0; word < INDEXSET_BITMAP_WORDS; word++)
+            for (quint64 bits = container.bitmap[word]; bits; bits &= bits - 1)
+                array << quint16(word << 6 | qCountTrailingZeroBits(bits));
+    }
+
+    return array;
+}
+
+template <typename Container>
+static QVector<quint64> containerBitmap(const Container &container)
+{
+    if (!container.bitmap.isEmpty())
+        return container.bitmap;
+
+    QVector<quint64> bitmap(INDEXSET_BITMAP_WORDS, 0);
+
+    for (quint16 value: container.array)
+        bitmap[value >> 6] |= quint64(1) << (value & 0x3f);
+
+    for (int i = 0; i < container.runs.size(); i += 2)
+        setBits(bitmap.data(), container.runs[i], container.runs[i + 1]);
+
+    return bitmap;
+}
+
+// Updates the count of container and moves its contents to the smallest
+// form. Ties go to runs, then to the array, so every content has a single
+// representation. Returns false if it's empty.
+template <typename Container>
+static bool normalize(Container &container)
+{
+    qint64 runCount = 0;
+
+    if (!container.array.isEmpty()) {
+        container.count = container.array.size();
+        runCount = container.count;
+
+        for (int i = 1; i < container.array.size(); i++)
+            if (container.array[i] == container.array[i - 1] + 1)
+                runCount--;
+    } else if (container.bitmap.isEmpty()) {
+        container.count = 0;
+        runCount = container.runs.size() / 2;
+
+        for (int i = 0; i < container.runs.size(); i += 2)
+            container.count += container.runs[i + 1] - container.runs[i] + 1;
+    } else {
+        container.count = 0;
+
+        for (quint64 bits: container.bitmap)
+            container.count += qPopulationCount(bits);
+
+        runCount = bitmapRunCount(container.bitmap.constData());
+    }
+
+    if (container.count < 1) {
+        container.runs.clear();
+        container.array.clear();
+        container.bitmap.clear();
+
+        return false;
+    }
+
+    qint64 runsBytes = 2 * runCount * qint64(sizeof(quint16));
+    qint64 arrayBytes = container.count * qint64(sizeof(quint16));
+
+    if (runsBytes <= arrayBytes && runsBytes <= INDEXSET_BITMAP_BYTES) {
+        if (!container.runs.isEmpty())
+            return true;
+
+        container.runs = containerRuns(container);
+        container.array.clear();
+        container.bitmap.clear();
+    } else if (arrayBytes <= INDEXSET_BITMAP_BYTES) {
+        if (!container.array.isEmpty())
+            return true;
+
+        container.array = containerArray(container);
+        container.runs.clear();
+        container.bitmap.clear();
+    } else {
+        if (!container.bitmap.isEmpty())
+            return true;
+
+        container.bitmap = containerBitmap(container);
+        container.runs.clear();
+        container.array.clear();
+    }
+
+    return true;
+}
+
+template <typename Container>
+static Container uniteContainers(const Container &a, const Container &b)
+{
+    Container result;
+    result.key = a.key;
+    result.count = 0;
+
+    if (!a.bitmap.isEmpty() || !b.bitmap.isEmpty()) {
+        result.bitmap = containerBitmap(a);
+        QVector<quint64> other = containerBitmap(b);
+
+        for (int word = 0; word < INDEXSET_BITMAP_WORDS; word++)
+            result.bitmap[word] |= other[word];
+    } else {
+        QVector<quint16> aRuns = containerRuns(a);
+        QVector<quint16> bRuns = containerRuns(b);
+        int i = 0;
+        int j = 0;
+
+        while (i < aRuns.size() || j < bRuns.size()) {
+            if (j >= bRuns.size() || (i < aRuns.size() && aRuns[i] <= bRuns[j])) {
+                appendRun(result.runs, aRuns[i], aRuns[i + 1]);
+                i += 2;
+            } else {
+                appendRun(result.runs, bRuns[j], bRuns[j + 1]);
+                j += 2;
+            }
+        }
+    }
+
+    normalize(result);
+
+    return result;
+}
+
+template <typename Container>
+static Container intersectContainers(const Container &a, const Container &b)
+{
+    Container result;
+    result.key = a.key;
+    result.count = 0;
+
+    if (!a.bitmap.isEmpty() && !b.bitmap.isEmpty()) {
+        result.bitmap = a.bitmap;
+
+        for (int word = 0; word < INDEXSET_BITMAP_WORDS; word++)
+            result.bitmap[word] &= b.bitmap[word];
+    } else if (!a.array.isEmpty() && !b.bitmap.isEmpty()) {
+        for (quint16 value: a.array)
+            if (b.bitmap[value >> 6] >> (value & 0x3f) & 0x1)
+                result.array << value;
+    } else if (!b.array.isEmpty() && !a.bitmap.isEmpty()) {
+        return intersectContainers(b, a);
+    } else if (!a.bitmap.isEmpty() || !b.bitmap.isEmpty()) {
+        result.bitmap = containerBitmap(a);
+        QVector<quint64> other = containerBitmap(b);
+
+        for (int word = 0; word < INDEXSET_BITMAP_WORDS; word++)
+            result.bitmap[word] &= other[word];
+    } else {
+        QVector<quint16> aRuns = containerRuns(a);
+        QVector<quint16> bRuns = containerRuns(b);
+        int i = 0;
+        int j = 0;
+
+        while (i < aRuns.size() && j < bRuns.size()) {
+            int first = qMax(aRuns[i], bRuns[j]);
+            int last = qMin(aRuns[i + 1], bRuns[j + 1]);
+
+            if (first <= last)
+                result.runs << quint16(first) << quint16(last);
+
+            // Move past the run that ends first.
+            if (aRuns[i + 1] < bRuns[j + 1])
+                i += 2;
+            else
+                j += 2;
+        }
+    }
+
+    normalize(result);
+
+    return result;
+}
+
+static void writeVarint(QDataStream &ostream, quint64 value)
+{
+    while (value >= 0x80) {
+        ostream << quint8(value | 0x80);
+        value >>= 7;
+    }
+
+    ostream << quint8(value);
+}
+
+static bool readVarint(QDataStream &istream, quint64 *value)
+{
+    *value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7) {
+        quint8 byte = 0;
+        istream >> byte;
+
+        if (istream.status() != QDataStream::Ok)
+            return false;
+
+        *value |= quint64(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+IndexSet::IndexSet()
+{
+}
+
+IndexSet::IndexSet(const Range &range)
+{
+    qint64 size = range.size();
+
+    if (size < 1)
+        return;
+
+    // Don't reverse descending ranges, their stop could be past the biggest
+    // int.
+    bool ascending = range.step() > 0;
+    quint32 first = toStored(ascending? range.first(): range.last());
+    quint32 last = toStored(ascending? range.last(): range.first());
+
+    if (size == qint64(last) - qint64(first) + 1) {
+        for (quint32 key = first >> 16; key <= last >> 16; key++) {
+            Container container;
+            container.key = quint16(key);
+            container.runs << quint16(key == first >> 16? first: 0)
+                           << quint16(key == last >> 16? last: 0xffff);
+            normalize(container);
+            this->m_containers << container;
+        }
+
+        return;
+    }
+
+    for (qint64 i = 0; i < size; i++) {
+        quint32 stored = toStored(range.at(ascending? i: size - 1 - i));
+
+        if (this->m_containers.isEmpty()
+            || this->m_containers.last().key != stored >> 16) {
+            if (!this->m_containers.isEmpty())
+                normalize(this->m_containers.last());
+
+            Container container;
+            container.key = quint16(stored >> 16);
+            container.count = 0;
+            this->m_containers << container;
+        }
+
+        this->m_containers.last().array << quint16(stored);
+    }
+
+    normalize(this->m_containers.last());
+}
+
+IndexSet::IndexSet(const QVector<Range> &ranges)
+{
+    for (const Range &range: ranges)
+        this->add(range);
+}
+
+void IndexSet::add(int value)
+{
+    quint32 stored = toStored(value);
+    quint16 key = quint16(stored >> 16);
+    quint16 low = quint16(stored);
+    auto container =
+            std::lower_bound(this->m_containers.begin(),
+                             this->m_containers.end(),
+                             key,
+                             [] (const Container &container, quint16 key) {
+        return container.key < key;
+    });
+
+    if (container == this->m_containers.end() || container->key != key) {
+        Container added;
+        added.key = key;
+        added.runs << low << low;
+        normalize(added);
+        this->m_containers.insert(container, added);
+
+        return;
+    }
+
+    if (!container->bitmap.isEmpty()) {
+        container->bitmap[low >> 6] |= quint64(1) << (low & 0x3f);
+    } else if (!container->array.isEmpty()) {
+        auto it = std::lower_bound(container->array.begin(),
+                                   container->array.end(),
+                                   low);
+
+        if (it != container->array.end() && *it == low)
+            return;
+
+        container->array.insert(it, low);
+    } else {
+        Container single;
+        single.key = key;
+        single.runs << low << low;
+        *container = uniteContainers(*container, single);
+
+        return;
+    }
+
+    normalize(*container);
+}
+
+void IndexSet::add(const Range &range)
+{
+    *this |= IndexSet(range);
+}
+
+int IndexSet::at(qint64 pos) const
+{
+    Q_ASSERT_X(pos >= 0 && pos < this->count(),
+               "IndexSet::at",
+               "index out of range");
+
+    for (const Container &container: this->m_containers) {
+        if (pos >= container.count) {
+            pos -= container.count;
+
+            continue;
+        }
+
+        quint32 high = quint32(container.key) << 16;
+
+        if (!container.array.isEmpty())
+            return fromStored(high | container.array[int(pos)]);
+
+        if (container.bitmap.isEmpty()) {
+            for (int i = 0; i < container.runs.size(); i += 2) {
+                int length = container.runs[i + 1] - container.runs[i] + 1;
+
+                if (pos < length)
+                    return fromStored(high | quint32(container.runs[i] + pos));
+
+                pos -= length;
+            }
+        } else {
+            for (int word = 0; word < INDEXSET_BITMAP_WORDS; word++) {
+                quint64 bits = container.bitmap[word];
+                int count = qPopulationCount(bits);
+
+                if (pos >= count) {
+                    pos -= count;
+
+                    continue;
+                }
+
+                // Drop the lowest set bits until the one we look for.
+                for (; pos > 0; pos--)
+                    bits &= bits - 1;
+
+                return fromStored(high
+                                  | quint32(word << 6)
+                                  | quint32(qCountTrailingZeroBits(bits)));
+            }
+        }
+    }
+
+    return 0;
+}
+
+IndexSet::const_iterator IndexSet::begin() const
+{
+    return const_iterator(&this->m_containers, 0);
+}
+
+IndexSet::const_iterator IndexSet::cbegin() const
+{
+    return this->begin();
+}
+
+IndexSet::const_iterator IndexSet::cend() const
+{
+    return this->end();
+}
+
+void IndexSet::clear()
+{
+    this->m_containers.clear();
+}
+
+bool IndexSet::contains(int value) const
+{
+    quint32 stored = toStored(value);
+    quint16 key = quint16(stored >> 16);
+    quint16 low = quint16(stored);
+    auto container =
+            std::lower_bound(this->m_containers.constBegin(),
+                             this->m_containers.constEnd(),
+                             key,
+                             [] (const Container &container, quint16 key) {
+        return container.key < key;
+    });
+
+    if (container == this->m_containers.constEnd() || container->key != key)
+        return false;
+
+    if (!container->bitmap.isEmpty())
+        return container->bitmap[low >> 6] >> (low & 0x3f) & 0x1;
+
+    if (!container->array.isEmpty())
+        return std::binary_search(container->array.constBegin(),
+                                  container->array.constEnd(),
+                                  low);
+
+    // Find the last run starting at or before low.
+    int first = 0;
+    int last = container->runs.size() / 2 - 1;
+
+    while (first < last) {
+        int middle = (first + last + 1) / 2;
+
+        if (container->runs[2 * middle] <= low)
+            first = middle;
+        else
+            last = middle - 1;
+    }
+
+    return container->runs[2 * first] <= low
+           && low <= container->runs[2 * first + 1];
+}
+
+qint64 IndexSet::count() const
+{
+    qint64 count = 0;
+
+    for (const Container &container: this->m_containers)
+        count += container.count;
+
+    return count;
+}
+
+IndexSet::const_iterator IndexSet::end() const
+{
+    return const_iterator(&this->m_containers, this->m_containers.size());
+}
+
+IndexSet IndexSet::intersected(const IndexSet &other) const
+{
+    IndexSet result;
+    int i = 0;
+    int j = 0;
+
+    while (i < this->m_containers.size() && j < other.m_containers.size()) {
+        const Container &a = this->m_containers[i];
+        const Container &b = other.m_containers[j];
+
+        if (a.key < b.key) {
+            i++;
+        } else if (b.key < a.key) {
+            j++;
+        } else {
+            Container container = intersectContainers(a, b);
+
+            if (container.count > 0)
+                result.m_containers << container;
+
+            i++;
+            j++;
+        }
+    }
+
+    return result;
+}
+
+bool IndexSet::isEmpty() const
+{
+    return this->m_containers.isEmpty();
+}
+
+qint64 IndexSet::memoryUsage() const
+{
+    qint64 bytes = sizeof(IndexSet)
+                 + this->m_containers.size() * qint64(sizeof(Container));
+
+    for (const Container &container: this->m_containers)
+        bytes += (container.runs.size() + container.array.size())
+                 * qint64(sizeof(quint16))
+               + container.bitmap.size() * qint64(sizeof(quint64));
+
+    return bytes;
+}
+
+QVector<Range> IndexSet::runs() const
+{
+    QVector<Range> runs;
+
+    // A run that ends at the biggest int has no stop past it, its last
+    // element goes in a range of its own, with the stop before it.
+    auto appendRun = [&runs] (qint64 first, qint64 last) {
+        int firstValue = fromStored(quint32(first));
+        int lastValue = fromStored(quint32(last));
+
+        if (lastValue < std::numeric_limits<int>::max()) {
+            runs << Range(firstValue, lastValue + 1);
+
+            return;
+        }
+
+        if (firstValue < lastValue)
+            runs << Range(firstValue, lastValue);
+
+        runs << Range(lastValue, lastValue - 1, -1);
+    };
+
+    // Runs that cross a container boundary are split in the containers, join
+    // them back.
+    qint64 first = -1;
+    qint64 last = -2;
+
+    auto addRun = [&] (qint64 runFirst, qint64 runLast) {
+        if (runFirst == last + 1) {
+            last = runLast;
+
+            return;
+        }
+
+        if (first >= 0)
+            appendRun(first, last);
+
+        first = runFirst;
+        last = runLast;
+    };
+
+    for (const Container &container: this->m_containers) {
+        qint64 high = qint64(container.key) << 16;
+        QVector<quint16> containerRuns = ::containerRuns(container);
+
+        for (int i = 0; i < containerRuns.size(); i += 2)
+            addRun(high | containerRuns[i], high | containerRuns[i + 1]);
+    }
+
+    if (first >= 0)
+        appendRun(first, last);
+
+    return runs;
+}
+
+qint64 IndexSet::size() const
+{
+    return this->count();
+}
+
+QVector<IndexSet> IndexSet::split(int n) const
+{
+    qint64 count = this->count();
+    n = int(qBound<qint64>(1, n, qMax<qint64>(count, 1)));
+    QVector<IndexSet> parts;
+    qint64 first = 0;
+
+    for (int i = 1; i < n; i++) {
+        qint64 last = toStored(this->at(i * (count / n) + qMin<qint64>(i, count % n)));
+        parts << this->valueSlice(first, last);
+        first = last;
+    }
+
+    parts << this->valueSlice(first, INDEXSET_VALUE_LIMIT);
+
+    return parts;
+}
+
+QVector<int> IndexSet::toVector() const
+{
+    QVector<int> values;
+    values.reserve(int(this->count()));
+
+    for (int value: *this)
+        values << value;
+
+    return values;
+}
+
+IndexSet IndexSet::united(const IndexSet &other) const
+{
+    IndexSet result;
+    int i = 0;
+    int j = 0;
+
+    while (i < this->m_containers.size() || j < other.m_containers.size()) {
+        if (j >= other.m_containers.size()
+            || (i < this->m_containers.size()
+                && this->m_containers[i].key < other.m_containers[j].key)) {
+            result.m_containers << this->m_containers[i++];
+        } else if (i >= this->m_containers.size()
+                   || other.m_containers[j].key < this->m_containers[i].key) {
+            result.m_containers << other.m_containers[j++];
+        } else {
+            result.m_containers << uniteContainers(this->m_containers[i++],
+                                                   other.m_containers[j++]);
+        }
+    }
+
+    return result;
+}
+
+bool IndexSet::operator ==(const IndexSet &other) const
+{
+    if (this->m_containers.size() != other.m_containers.size())
+        return false;
+
+    // Containers are normalized, the same contents have the same
+    // representation.
+    for (int i = 0; i < this->m_containers.size(); i++) {
+        const Container &a = this->m_containers[i];
+        const Container &b = other.m_containers[i];
+
+        if (a.key != b.key
+            || a.count != b.count
+            || a.runs != b.runs
+            || a.array != b.array
+            || a.bitmap != b.bitmap)
+            return false;
+    }
+
+    return true;
+}
+
+bool IndexSet::operator !=(const IndexSet &other) const
+{
+    return !(*this == other);
+}
+
+IndexSet IndexSet::operator &(const IndexSet &other) const
+{
+    return this->intersected(other);
+}
+
+IndexSet &IndexSet::operator &=(const IndexSet &other)
+{
+    *this = this->intersected(other);
+
+    return *this;
+}
+
+IndexSet IndexSet::operator |(const IndexSet &other) const
+{
+    return this->united(other);
+}
+
+IndexSet &IndexSet::operator |=(const IndexSet &other)
+{
+    *this = this->united(other);
+
+    return *this;
+}
+
+// The indexes whose stored values are in [first, last).
+IndexSet IndexSet::valueSlice(qint64 first, qint64 last) const
+{
+    IndexSet slice;
+
+    for (const Container &container: this->m_containers) {
+        qint64 containerFirst = qint64(container.key) << 16;
+        qint64 containerLast = containerFirst + INDEXSET_CONTAINER_SIZE;
+
+        if (containerLast <= first || containerFirst >= last)
+            continue;
+
+        if (first <= containerFirst && containerLast <= last) {
+            slice.m_containers << container;
+
+            continue;
+        }
+
+        Container bounds;
+        bounds.key = container.key;
+        bounds.runs << quint16(qMax(first, containerFirst) - containerFirst)
+                    << quint16(qMin(last, containerLast) - 1 - containerFirst);
+        Container part = intersectContainers(container, bounds);
+
+        if (part.count > 0)
+            slice.m_containers << part;
+    }
+
+    return slice;
+}
+
+QDebug operator <<(QDebug debug, const IndexSet &set)
+{
+    debug.nospace() << "IndexSet(";
+    bool first = true;
+
+    for (const Range &run: set.runs()) {
+        if (!first)
+            debug.nospace() << ", ";
+
+        debug.nospace() << run.start() << ".." << run.stop();
+        first = false;
+    }
+
+    debug.nospace() << ")";
+
+    return debug.space();
+}
+
+// Every container is written as the difference between its key and the
+// previous one and its kind, followed by its contents as varints: runs as
+// the gap from the end of the previous run and the length minus one, arrays
+// as the gaps between values minus one. Bitmaps are written as raw words.
+QDataStream &operator >>(QDataStream &istream, IndexSet &set)
+{
+    set.clear();
+    quint64 containers = 0;
+    quint64 key = 0;
+
+    if (!readVarint(istream, &containers))
+        return istream;
+
+    for (quint64 i = 0; i < containers; i++) {
+        quint64 keyDelta = 0;
+        quint8 kind = 0;
+        bool ok = readVarint(istream, &keyDelta);
+        istream >> kind;
+        key += keyDelta;
+        ok &= istream.status() == QDataStream::Ok
+              && key < INDEXSET_CONTAINER_SIZE
+              && (i == 0 || keyDelta > 0);
+
+        IndexSet::Container container;
+        container.key = quint16(key);
+        container.count = 0;
+        quint64 size = 0;
+
+        if (ok && kind == INDEXSET_KIND_BITMAP) {
+            container.bitmap.resize(INDEXSET_BITMAP_WORDS);
+
+            for (quint64 &word: container.bitmap)
+                istream >> word;
+
+            ok = istream.status() == QDataStream::Ok;
+        } else if (ok && kind == INDEXSET_KIND_ARRAY) {
+            quint64 next = 0;
+            ok = readVarint(istream, &size) && size <= INDEXSET_CONTAINER_SIZE;
+
+            for (quint64 j = 0; ok && j < size; j++) {
+                quint64 gap = 0;
+                ok = readVarint(istream, &gap) && next + gap < INDEXSET_CONTAINER_SIZE;
+
+                if (ok) {
+                    container.array << quint16(next + gap);
+                    next += gap + 1;
+                }
+            }
+        } else if (ok && kind == INDEXSET_KIND_RUNS) {
+            quint64 next = 0;
+            ok = readVarint(istream, &size) && size <= INDEXSET_CONTAINER_SIZE / 2;
+
+            for (quint64 j = 0; ok && j < size; j++) {
+                quint64 gap = 0;
+                quint64 length = 0;
+                ok = readVarint(istream, &gap)
+                     && readVarint(istream, &length)
+                     && next + gap + length < INDEXSET_CONTAINER_SIZE;
+
+                if (ok) {
+                    container.runs << quint16(next + gap)
+                                   << quint16(next + gap + length);
+                    next += gap + length + 2;
+                }
+            }
+        } else {
+            ok = false;
+        }
+
+        if (!ok || !normalize(container)) {
+            istream.setStatus(QDataStream::ReadCorruptData);
+            set.clear();
+
+            return istream;
+        }
+
+        set.m_containers << container;
+    }
+
+    return istream;
+}
+
+QDataStream &operator <<(QDataStream &ostream, const IndexSet &set)
+{
+    writeVarint(ostream, quint64(set.m_containers.size()));
+    quint64 key = 0;
+
+    for (const IndexSet::Container &container: set.m_containers) {
+        writeVarint(ostream, container.key - key);
+        key = container.key;
+        quint64 next = 0;
+
+        if (!container.bitmap.isEmpty()) {
+            ostream << quint8(INDEXSET_KIND_BITMAP);
+
+            for (quint64 word: container.bitmap)
+                ostream << word;
+        } else if (!container.array.isEmpty()) {
+            ostream << quint8(INDEXSET_KIND_ARRAY);
+            writeVarint(ostream, quint64(container.array.size()));
+
+            for (quint16 value: container.array) {
+                writeVarint(ostream, value - next);
+                next = quint64(value) + 1;
+            }
+        } else {
+            ostream << quint8(INDEXSET_KIND_RUNS);
+            writeVarint(ostream, quint64(container.runs.size() / 2));
+
+            for (int i = 0; i < container.runs.size(); i += 2) {
+                writeVarint(ostream, container.runs[i] - next);
+                writeVarint(ostream, container.runs[i + 1] - container.runs[i]);
+                next = quint64(container.runs[i + 1]) + 2;
+            }
+        }
+    }
+
+    return ostream;
+}
@@ -0,0 +1,289 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef INDEXSET_H
+#define INDEXSET_H
+
+#include <algorithm>
+#include <iterator>
+#include <QDataStream>
+#include <QtDebug>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include "range.h"
+#include "trace.h"
+
+// Words of a bitmap container, one bit for every index it covers.
+#define INDEXSET_BITMAP_WORDS 1024
+
+// A set of indexes stored as sorted runs of consecutive values, for the
+// selections a single Range can't describe.
+// Indexes are grouped in containers of 65536 values, roaring bitmap style.
+// Every container keeps its indexes in the smallest of three forms: runs as
+// pairs of first and last values, a sorted array of values, or a bitmap. So
+// long runs take a few bytes, scattered indexes 2 bytes each, and dense
+// regions 1 bit per value, instead of the 4 bytes per index, or more, of a
+// QList<int>.
+class IndexSet
+{
+    private:
+        struct Container
+        {
+            quint16 key;
+            int count;
+
+            // Only one of the forms is used, the others are empty.
+            // first, last pairs, sorted, neither overlapping nor adjacent.
+            QVector<quint16> runs;
+
+            // Sorted values.
+            QVector<quint16> array;
+
+            // INDEXSET_BITMAP_WORDS words.
+            QVector<quint64> bitmap;
+        };
+
+    public:
+        class const_iterator
+        {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef int value_type;
+                typedef qint64 difference_type;
+                typedef const int *pointer;
+                typedef int reference;
+
+                const_iterator();
+                int operator *() const;
+                bool operator ==(const const_iterator &other) const;
+                bool operator !=(const const_iterator &other) const;
+                const_iterator &operator ++();
+                const_iterator operator ++(int);
+
+            private:
+                const QVector<Container> *m_containers;
+                int m_container;
+                int m_run;
+                int m_low;
+
+                const_iterator(const QVector<Container> *containers,
+                               int container);
+                void seekContainer();
+
+                friend class IndexSet;
+        };
+
+        typedef const_iterator iterator;
+
+        IndexSet();
+        IndexSet(const Range &range);
+        explicit IndexSet(const QVector<Range> &ranges);
+        void add(int value);
+        void add(const Range &range);
+
+        // The index at position pos in ascending order.
+        int at(qint64 pos) const;
+        const_iterator begin() const;
+        const_iterator cbegin() const;
+        const_iterator cend() const;
+        void clear();
+        bool contains(int value) const;
+        qint64 count() const;
+        const_iterator end() const;
+        IndexSet intersected(const IndexSet &other) const;
+        bool isEmpty() const;
+
+        // Approximate bytes of memory taken by the set.
+        qint64 memoryUsage() const;
+
+        // The set as ascending runs of consecutive indexes. The biggest int
+        // can't be inside a run, it comes last as a one element descending
+        // range.
+        QVector<Range> runs() const;
+        qint64 size() const;
+
+        // Cuts the set in n consecutive sub-sets, with counts differing at
+        // most by one index.
+        QVector<IndexSet> split(int n) const;
+        QVector<int> toVector() const;
+        IndexSet united(const IndexSet &other) const;
+        bool operator ==(const IndexSet &other) const;
+        bool operator !=(const IndexSet &other) const;
+        IndexSet operator &(const IndexSet &other) const;
+        IndexSet &operator &=(const IndexSet &other);
+        IndexSet operator |(const IndexSet &other) const;
+        IndexSet &operator |=(const IndexSet &other);
+
+        friend QDebug operator <<(QDebug debug, const IndexSet &set);
+        friend QDataStream &operator >>(QDataStream &istream, IndexSet &set);
+        friend QDataStream &operator <<(QDataStream &ostream, const IndexSet &set);
+
+    private:
+        QVector<Container> m_containers;
+
+        IndexSet valueSlice(qint64 first, qint64 last) const;
+};
+
+// Runs function(const IndexSet &part) over balanced parts of set in the
+// global thread pool, one per thread.
+template <typename Function>
+void parallelFor(const IndexSet &set, Function function)
+{
+    QVector<IndexSet> parts =
+            set.split(QThreadPool::globalInstance()->maxThreadCount());
+
+    auto runPart = [&function] (const IndexSet &part) {
+        TRACE_SCOPE("parallelFor/IndexSet", part.count());
+        function(part);
+    };
+
+    if (parts.size() < 2) {
+        for (const IndexSet &part: parts)
+            runPart(part);
+
+        return;
+    }
+
+    QtConcurrent::blockingMap(parts, runPart);
+}
+
+inline IndexSet::const_iterator::const_iterator():
+    m_containers(nullptr),
+    m_container(0),
+    m_run(0),
+    m_low(0)
+{
+}
+
+inline IndexSet::const_iterator::const_iterator(const QVector<Container> *containers,
+                                                int container):
+    m_containers(containers),
+    m_container(container),
+    m_run(0),
+    m_low(0)
+{
+    this->seekContainer();
+}
+
+inline int IndexSet::const_iterator::operator *() const
+{
+    quint32 value = quint32((*this->m_containers)[this->m_container].key) << 16
+                  | quint32(this->m_low);
+
+    return int(value ^ 0x80000000u);
+}
+
+inline bool IndexSet::const_iterator::operator ==(const const_iterator &other) const
+{
+    return this->m_container == other.m_container
+           && this->m_run == other.m_run
+           && this->m_low == other.m_low;
+}
+
+inline bool IndexSet::const_iterator::operator !=(const const_iterator &other) const
+{
+    return !(*this == other);
+}
+
+inline IndexSet::const_iterator &IndexSet::const_iterator::operator ++()
+{
+    const Container &container = (*this->m_containers)[this->m_container];
+
+    if (!container.array.isEmpty()) {
+        this->m_run++;
+
+        if (this->m_run < container.array.size()) {
+            this->m_low = container.array[this->m_run];
+
+            return *this;
+        }
+    } else if (container.bitmap.isEmpty()) {
+        if (this->m_low < container.runs[2 * this->m_run + 1]) {
+            this->m_low++;
+
+            return *this;
+        }
+
+        this->m_run++;
+
+        if (2 * this->m_run < container.runs.size()) {
+            this->m_low = container.runs[2 * this->m_run];
+
+            return *this;
+        }
+    } else {
+        int bit = this->m_low + 1;
+        int word = bit >> 6;
+
+        if (word < INDEXSET_BITMAP_WORDS) {
+            quint64 bits = container.bitmap[word] & (~quint64(0) << (bit & 0x3f));
+
+            while (!bits && ++word < INDEXSET_BITMAP_WORDS)
+                bits = container.bitmap[word];
+
+            if (bits) {
+                this->m_low = (word << 6) | qCountTrailingZeroBits(bits);
+
+                return *this;
+            }
+        }
+    }
+
+    this->m_container++;
+    this->seekContainer();
+
+    return *this;
+}
+
+inline IndexSet::const_iterator IndexSet::const_iterator::operator ++(int)
+{
+    const_iterator it = *this;
+    ++*this;
+
+    return it;
+}
+
+inline void IndexSet::const_iterator::seekContainer()
+{
+    this->m_run = 0;
+    this->m_low = 0;
+
+    if (this->m_container >= this->m_containers->size())
+        return;
+
+    const Container &container = (*this->m_containers)[this->m_container];
+
+    if (!container.array.isEmpty()) {
+        this->m_low = container.array[0];
+    } else if (container.bitmap.isEmpty()) {
+        this->m_low = container.runs[0];
+    } else {
+        int word = 0;
+
+        while (!container.bitmap[word])
+            word++;
+
+        this->m_low = (word << 6) | qCountTrailingZeroBits(container.bitmap[word]);
+    }
+}
+
+#endif // INDEXSET_H
@@ -0,0 +1,1508 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#include <limits>
+
+#include "kernels.h"
+
+#if defined(Q_PROCESSOR_X86) && (defined(Q_CC_GNU) || defined(Q_CC_CLANG))
+#define KERNELS_X86
+#include <immintrin.h>
+
+#define KERNEL_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+// A value is in the range if rotr((value - start) * multiplier, shift) < count,
+// see RangeDivisor. Descending ranges negate the multiplier instead of the
+// distance.
+struct ContainsArgs
+{
+    qint32 start;
+    quint32 multiplier;
+    int shift;
+    quint32 count;
+};
+
+struct KernelTable
+{
+    quint32 (*sumU32)(const quint32 *data, int size);
+    quint32 (*minU32)(const quint32 *data, int size);
+    quint32 (*maxU32)(const quint32 *data, int size);
+    quint32 (*dotU32)(const quint32 *a, const quint32 *b, int size);
+    float (*sumF32)(const float *data, int size);
+    float (*minF32)(const float *data, int size);
+    float (*maxF32)(const float *data, int size);
+    float (*dotF32)(const float *a, const float *b, int size);
+    void (*iotaI32)(qint32 *dst, int size, qint32 start, qint32 step);
+    void (*containsI32)(const qint32 *values,
+                        int size,
+                        const ContainsArgs &args,
+                        bool *out);
+    void (*addF32)(float *dst, const float *a, const float *b, int size);
+    void (*mulF32)(float *dst, const float *a, const float *b, int size);
+    void (*fmaF32)(float *dst,
+                   const float *a,
+                   const float *b,
+                   const float *c,
+                   int size);
+    void (*axpyF32)(float *y, float alpha, const float *x, int size);
+    void (*clampF32)(float *dst, const float *src, int size, float min, float max);
+    void (*convertU32F32)(float *dst, const quint32 *src, int size);
+};
+
+#define U32_MIN std::numeric_limits<quint32>::min()
+#define U32_MAX std::numeric_limits<quint32>::max()
+#define F32_MIN (-std::numeric_limits<float>::infinity())
+#define F32_MAX std::numeric_limits<float>::infinity()
+
+// Scalar kernels, also used for the tails of the vectorized ones.
+
+template <typename T>
+static inline T sumScalar(const T *data, int size, T sum=0)
+{
+    for (int i = 0; i < size; i++)
+        sum += data[i];
+
+    return sum;
+}
+
+template <typename T>
+static inline T minScalar(const T *data, int size, T min)
+{
+    for (int i = 0; i < size; i++)
+        min = qMin(min, data[i]);
+
+    return min;
+}
+
+template <typename T>
+static inline T maxScalar(const T *data, int size, T max)
+{
+    for (int i = 0; i < size; i++)
+        max = qMax(max, data[i]);
+
+    return max;
+}
+
+template <typename T>
+static inline T dotScalar(const T *a, const T *b, int size, T dot=0)
+{
+    for (int i = 0; i < size; i++)
+        dot += a[i] * b[i];
+
+    return dot;
+}
+
+// Iota is computed in unsigned arithmetic, so overflow wraps around instead of
+// being undefined.
+static inline void iotaScalar(qint32 *dst,
+                              int size,
+                              qint32 start,
+                              qint32 step,
+                              int offset=0)
+{
+    for (int i = offset; i < size; i++)
+        dst[i] = qint32(quint32(start) + quint32(i) * quint32(step));
+}
+
+static inline void containsScalar(const qint32 *values,
+                                  int size,
+                                  const ContainsArgs &args,
+                                  bool *out,
+                                  int offset=0)
+{
+    for (int i = offset; i < size; i++) {
+        quint32 q = (quint32(values[i]) - quint32(args.start)) * args.multiplier;
+        q = args.shift? q >> args.shift | q << (32 - args.shift): q;
+        out[i] = q < args.count;
+    }
+}
+
+// The elementwise kernels take an offset to be used for the heads and tails
+// of the vectorized ones: the head is [0, size) and the tail [offset, size).
+
+static inline void addScalar(float *dst,
+                             const float *a,
+                             const float *b,
+                             int size,
+                             int offset=0)
+{
+    for (int i = offset; i < size; i++)
+        dst[i] = a[i] + b[i];
+}
+
+static inline void mulScalar(float *dst,
+                             const float *a,
+                             const float *b,
+                             int size,
+                             int offset=0)
+{
+    for (int i = offset; i < size; i++)
+        dst[i] = a[i] * b[i];
+}
+
+static inline void fmaScalar(float *dst,
+                             const float *a,
+                             const float *b,
+                             const float *c,
+                             int size,
+                             int offset=0)
+{
+    for (int i = offset; i < size; i++)
+        dst[i] = a[i] * b[i] + c[i];
+}
+
+static inline void axpyScalar(float *y,
+                              float alpha,
+                              const float *x,
+                              int size,
+                              int offset=0)
+{
+    for (int i = offset; i < size; i++)
+        y[i] += alpha * x[i];
+}
+
+// Written as the max and min instructions work, so NaN gives min in every
+// instruction set.
+static inline void clampScalar(float *dst,
+                               const float *src,
+                               float min,
+                               float max,
+                               int size,
+                               int offset=0)
+{
+    for (int i = offset; i < size; i++) {
+        float value = src[i] > min? src[i]: min;
+        dst[i] = value < max? value: max;
+    }
+}
+
+static inline void convertScalar(float *dst,
+                                 const quint32 *src,
+                                 int size,
+                                 int offset=0)
+{
+    for (int i = offset; i < size; i++)
+        dst[i] = float(src[i]);
+}
+
+// Number of elements before dst reaches an address multiple of bytes, the
+// vectorized elementwise kernels peel them so that every store is aligned.
+static inline int alignmentHead(const float *dst, int size, int bytes)
+{
+    quintptr address = quintptr(dst);
+
+    // Not even aligned to a float, don't vectorize.
+    if (address % sizeof(float))
+        return size;
+
+    return qMin(size, int((bytes - address % bytes) % bytes / sizeof(float)));
+}
+
+static quint32 sumU32Scalar(const quint32 *data, int size)
+{
+    return sumScalar(data, size);
+}
+
+static quint32 minU32Scalar(const quint32 *data, int size)
+{
+    return minScalar(data, size, U32_MAX);
+}
+
+static quint32 maxU32Scalar(const quint32 *data, int size)
+{
+    return maxScalar(data, size, U32_MIN);
+}
+
+static quint32 dotU32Scalar(const quint32 *a, const quint32 *b, int size)
+{
+    return dotScalar(a, b, size);
+}
+
+static float sumF32Scalar(const float *data, int size)
+{
+    return sumScalar(data, size);
+}
+
+static float minF32Scalar(const float *data, int size)
+{
+    return minScalar(data, size, F32_MAX);
+}
+
+static float maxF32Scalar(const float *data, int size)
+{
+    return maxScalar(data, size, F32_MIN);
+}
+
+static float dotF32Scalar(const float *a, const float *b, int size)
+{
+    return dotScalar(a, b, size);
+}
+
+static void iotaI32Scalar(qint32 *dst, int size, qint32 start, qint32 step)
+{
+    iotaScalar(dst, size, start, step);
+}
+
+static void containsI32Scalar(const qint32 *values,
+                              int size,
+                              const ContainsArgs &args,
+                              bool *out)
+{
+    containsScalar(values, size, args, out);
+}
+
+static void addF32Scalar(float *dst, const float *a, const float *b, int size)
+{
+    addScalar(dst, a, b, size);
+}
+
+static void mulF32Scalar(float *dst, const float *a, const float *b, int size)
+{
+    mulScalar(dst, a, b, size);
+}
+
+static void fmaF32Scalar(float *dst,
+                         const float *a,
+                         const float *b,
+                         const float *c,
+                         int size)
+{
+    fmaScalar(dst, a, b, c, size);
+}
+
+static void axpyF32Scalar(float *y, float alpha, const float *x, int size)
+{
+    axpyScalar(y, alpha, x, size);
+}
+
+static void clampF32Scalar(float *dst,
+                           const float *src,
+                           int size,
+                           float min,
+                           float max)
+{
+    clampScalar(dst, src, min, max, size);
+}
+
+static void convertU32F32Scalar(float *dst, const quint32 *src, int size)
+{
+    convertScalar(dst, src, size);
+}
+
+static const KernelTable scalarKernels = {
+    sumU32Scalar,
+    minU32Scalar,
+    maxU32Scalar,
+    dotU32Scalar,
+    sumF32Scalar,
+    minF32Scalar,
+    maxF32Scalar,
+    dotF32Scalar,
+    iotaI32Scalar,
+    containsI32Scalar,
+    addF32Scalar,
+    mulF32Scalar,
+    fmaF32Scalar,
+    axpyF32Scalar,
+    clampF32Scalar,
+    convertU32F32Scalar
+};
+
+#ifdef KERNELS_X86
+
+// SSE2 kernels. SSE2 lacks unsigned 32 bits min/max and 32 bits multiply, so
+// those are emulated.
+
+KERNEL_TARGET("sse2")
+static inline __m128i loadU32Sse2(const quint32 *data)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+}
+
+KERNEL_TARGET("sse2")
+static inline __m128i selectU32Sse2(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+KERNEL_TARGET("sse2")
+static inline __m128i greaterU32Sse2(__m128i a, __m128i b)
+{
+    const __m128i sign = _mm_set1_epi32(std::numeric_limits<qint32>::min());
+
+    return _mm_cmpgt_epi32(_mm_xor_si128(a, sign), _mm_xor_si128(b, sign));
+}
+
+KERNEL_TARGET("sse2")
+static quint32 sumU32Sse2(const quint32 *data, int size)
+{
+    __m128i sum = _mm_setzero_si128();
+    int i = 0;
+
+    for (; i + 4 <= size; i += 4)
+        sum = _mm_add_epi32(sum, loadU32Sse2(data + i));
+
+    quint32 lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), sum);
+
+    return sumScalar(data + i, size - i, sumScalar(lanes, 4));
+}
+
+KERNEL_TARGET("sse2")
+static quint32 minU32Sse2(const quint32 *data, int size)
+{
+    __m128i min = _mm_set1_epi32(-1);
+    int i = 0;
+
+    for (; i + 4 <= size; i += 4) {
+        __m128i v = loadU32Sse2(data + i);
+        min = selectU32Sse2(greaterU32Sse2(min, v), v, min);
+    }
+
+    quint32 lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), min);
+
+    return minScalar(data + i, size - i, minScalar(lanes, 4, U32_MAX));
+}
+
+KERNEL_TARGET("sse2")
+static quint32 maxU32Sse2(const quint32 *data, int size)
+{
+    __m128i max = _mm_setzero_si128();
+    int i = 0;
+
+    for (; i + 4 <= size; i += 4) {
+        __m128i v = loadU32Sse2(data + i);
+        max = selectU32Sse2(greaterU32Sse2(v, max), v, max);
+    }
+
+    quint32 lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), max);
+
+    return maxScalar(data + i, size - i, maxScalar(lanes, 4, U32_MIN));
+}
+
+KERNEL_TARGET("sse2")
+static quint32 dotU32Sse2(const quint32 *a, const quint32 *b, int size)
+{
+    // The low 32 bits of the sum of the 64 bits products are the same as the
+    // wrapped around 32 bits sum of products.
+    __m128i dot = _mm_setzero_si128();
+    int i = 0;
+
+    for (; i + 4 <= size; i += 4) {
+        __m128i va = loadU32Sse2(a + i);
+        __m128i vb = loadU32Sse2(b + i);
+        __m128i even = _mm_mul_epu32(va, vb);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(va, 32),
+                                    _mm_srli_epi64(vb, 32));
+        dot = _mm_add_epi64(dot, _mm_add_epi64(even, odd));
+    }
+
+    quint64 lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), dot);
+
+    return dotScalar(a + i,
+                     b + i,
+                     size - i,
+                     quint32(lanes[0] + lanes[1]));
+}
+
+KERNEL_TARGET("sse2")
+static float sumF32Sse2(const float *data, int size)
+{
+    __m128 sum = _mm_setzero_ps();
+    int i = 0;
+
+    for (; i + 4 <= size; i += 4)
+        sum = _mm_add_ps(sum, _mm_loadu_ps(data + i));
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum);
+
+    return sumScalar(data + i, size - i, sumScalar(lanes, 4));
+}
+
+KERNEL_TARGET("sse2")
+static float minF32Sse2(const float *data, int size)
+{
+    __m128 min = _mm_set1_ps(F32_MAX);
+    int i = 0;
+
+    for (; i + 4 <= size; i += 4)
+        min = _mm_min_ps(min, _mm_loadu_ps(data + i));
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, min);
+
+    return minScalar(data + i, size - i, minScalar(lanes, 4, F32_MAX));
+}
+
+KERNEL_TARGET("sse2")
+static float maxF32Sse2(const float *data, int size)
+{
+    __m128 max = _mm_set1_ps(F32_MIN);
+    int i = 0;
+
+    for (; i + 4 <= size; i += 4)
+        max = _mm_max_ps(max, _mm_loadu_ps(data + i));
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, max);
+
+    return maxScalar(data + i, size - i, maxScalar(lanes, 4, F32_MIN));
+}
+
+KERNEL_TARGET("sse2")
+static float dotF32Sse2(const float *a, const float *b, int size)
+{
+    __m128 dot = _mm_setzero_ps();
+    int i = 0;
+
+    for (; i + 4 <= size; i += 4)
+        dot = _mm_add_ps(dot, _mm_mul_ps(_mm_loadu_ps(a + i),
+                                         _mm_loadu_ps(b + i)));
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, dot);
+
+    return dotScalar(a + i, b + i, size - i, sumScalar(lanes, 4));
+}
+
+KERNEL_TARGET("sse2")
+static void iotaI32Sse2(qint32 *dst, int size, qint32 start, qint32 step)
+{
+    // Each lane advances by 4 steps per iteration, integer additions wrap
+    // around the same as the scalar version.
+    __m128i value = _mm_add_epi32(_mm_set1_epi32(start),
+                                  _mm_set_epi32(qint32(3 * quint32(step)),
+                                                qint32(2 * quint32(step)),
+                                                step,
+                                                0));
+    __m128i increment = _mm_set1_epi32(qint32(4 * quint32(step)));
+    int i = 0;
+
+    for (; i + 4 <= size; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), value);
+        value = _mm_add_epi32(value, increment);
+    }
+
+    iotaScalar(dst, size, start, step, i);
+}
+
+KERNEL_TARGET("sse2")
+static inline __m128i mulU32Sse2(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+KERNEL_TARGET("sse2")
+static inline __m128i containsMaskSse2(const qint32 *values,
+                                       __m128i start,
+                                       __m128i multiplier,
+                                       __m128i shiftRight,
+                                       __m128i shiftLeft,
+                                       __m128i count)
+{
+    // Shifts by 32 give 0, so a shift of 0 is a no-op rotation.
+    __m128i q = mulU32Sse2(_mm_sub_epi32(loadU32Sse2(reinterpret_cast<const quint32 *>(values)),
+                                         start),
+                           multiplier);
+    q = _mm_or_si128(_mm_srl_epi32(q, shiftRight), _mm_sll_epi32(q, shiftLeft));
+
+    return greaterU32Sse2(count, q);
+}
+
+KERNEL_TARGET("sse2")
+static void containsI32Sse2(const qint32 *values,
+                            int size,
+                            const ContainsArgs &args,
+                            bool *out)
+{
+    __m128i start = _mm_set1_epi32(args.start);
+    __m128i multiplier = _mm_set1_epi32(qint32(args.multiplier));
+    __m128i shiftRight = _mm_cvtsi32_si128(args.shift);
+    __m128i shiftLeft = _mm_cvtsi32_si128(args.shift? 32 - args.shift: 32);
+    __m128i count = _mm_set1_epi32(qint32(args.count));
+    __m128i one = _mm_set1_epi8(1);
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8) {
+        __m128i a = containsMaskSse2(values + i,
+                                     start,
+                                     multiplier,
+                                     shiftRight,
+                                     shiftLeft,
+                                     count);
+        __m128i b = containsMaskSse2(values + i + 4,
+                                     start,
+                                     multiplier,
+                                     shiftRight,
+                                     shiftLeft,
+                                     count);
+        __m128i mask = _mm_packs_epi32(a, b);
+        mask = _mm_and_si128(_mm_packs_epi16(mask, mask), one);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(out + i), mask);
+    }
+
+    containsScalar(values, size, args, out, i);
+}
+
+// SSE2 has no fused multiply-add, fma and axpy round the product.
+
+KERNEL_TARGET("sse2")
+static void addF32Sse2(float *dst, const float *a, const float *b, int size)
+{
+    int i = alignmentHead(dst, size, 16);
+    addScalar(dst, a, b, i);
+
+    for (; i + 4 <= size; i += 4)
+        _mm_store_ps(dst + i, _mm_add_ps(_mm_loadu_ps(a + i),
+                                         _mm_loadu_ps(b + i)));
+
+    addScalar(dst, a, b, size, i);
+}
+
+KERNEL_TARGET("sse2")
+static void mulF32Sse2(float *dst, const float *a, const float *b, int size)
+{
+    int i = alignmentHead(dst, size, 16);
+    mulScalar(dst, a, b, i);
+
+    for (; i + 4 <= size; i += 4)
+        _mm_store_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(a + i),
+                                         _mm_loadu_ps(b + i)));
+
+    mulScalar(dst, a, b, size, i);
+}
+
+KERNEL_TARGET("sse2")
+static void fmaF32Sse2(float *dst,
+                       const float *a,
+                       const float *b,
+                       const float *c,
+                       int size)
+{
+    int i = alignmentHead(dst, size, 16);
+    fmaScalar(dst, a, b, c, i);
+
+    for (; i + 4 <= size; i += 4)
+        _mm_store_ps(dst + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + i),
+                                                    _mm_loadu_ps(b + i)),
+                                         _mm_loadu_ps(c + i)));
+
+    fmaScalar(dst, a, b, c, size, i);
+}
+
+KERNEL_TARGET("sse2")
+static void axpyF32Sse2(float *y, float alpha, const float *x, int size)
+{
+    __m128 valpha = _mm_set1_ps(alpha);
+    int i = alignmentHead(y, size, 16);
+    axpyScalar(y, alpha, x, i);
+
+    for (; i + 4 <= size; i += 4)
+        _mm_store_ps(y + i, _mm_add_ps(_mm_mul_ps(valpha, _mm_loadu_ps(x + i)),
+                                       _mm_load_ps(y + i)));
+
+    axpyScalar(y, alpha, x, size, i);
+}
+
+KERNEL_TARGET("sse2")
+static void clampF32Sse2(float *dst,
+                         const float *src,
+                         int size,
+                         float min,
+                         float max)
+{
+    __m128 vmin = _mm_set1_ps(min);
+    __m128 vmax = _mm_set1_ps(max);
+    int i = alignmentHead(dst, size, 16);
+    clampScalar(dst, src, min, max, i);
+
+    for (; i + 4 <= size; i += 4)
+        _mm_store_ps(dst + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i),
+                                                    vmin),
+                                         vmax));
+
+    clampScalar(dst, src, min, max, size, i);
+}
+
+// There is no unsigned conversion before AVX-512. The high and low halves are
+// converted exactly and summed, which rounds once, as the scalar conversion.
+KERNEL_TARGET("sse2")
+static void convertU32F32Sse2(float *dst, const quint32 *src, int size)
+{
+    const __m128i low = _mm_set1_epi32(0xffff);
+    const __m128 scale = _mm_set1_ps(65536.0f);
+    int i = alignmentHead(dst, size, 16);
+    convertScalar(dst, src, i);
+
+    for (; i + 4 <= size; i += 4) {
+        __m128i v = loadU32Sse2(src + i);
+        __m128 high = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(v, 16)), scale);
+        _mm_store_ps(dst + i,
+                     _mm_add_ps(high, _mm_cvtepi32_ps(_mm_and_si128(v, low))));
+    }
+
+    convertScalar(dst, src, size, i);
+}
+
+static const KernelTable sse2Kernels = {
+    sumU32Sse2,
+    minU32Sse2,
+    maxU32Sse2,
+    dotU32Sse2,
+    sumF32Sse2,
+    minF32Sse2,
+    maxF32Sse2,
+    dotF32Sse2,
+    iotaI32Sse2,
+    containsI32Sse2,
+    addF32Sse2,
+    mulF32Sse2,
+    fmaF32Sse2,
+    axpyF32Sse2,
+    clampF32Sse2,
+    convertU32F32Sse2
+};
+
+// AVX2 kernels.
+
+KERNEL_TARGET("avx2")
+static inline __m256i loadU32Avx2(const quint32 *data)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+}
+
+KERNEL_TARGET("avx2")
+static quint32 sumU32Avx2(const quint32 *data, int size)
+{
+    __m256i sum = _mm256_setzero_si256();
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8)
+        sum = _mm256_add_epi32(sum, loadU32Avx2(data + i));
+
+    quint32 lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), sum);
+
+    return sumScalar(data + i, size - i, sumScalar(lanes, 8));
+}
+
+KERNEL_TARGET("avx2")
+static quint32 minU32Avx2(const quint32 *data, int size)
+{
+    __m256i min = _mm256_set1_epi32(-1);
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8)
+        min = _mm256_min_epu32(min, loadU32Avx2(data + i));
+
+    quint32 lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), min);
+
+    return minScalar(data + i, size - i, minScalar(lanes, 8, U32_MAX));
+}
+
+KERNEL_TARGET("avx2")
+static quint32 maxU32Avx2(const quint32 *data, int size)
+{
+    __m256i max = _mm256_setzero_si256();
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8)
+        max = _mm256_max_epu32(max, loadU32Avx2(data + i));
+
+    quint32 lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), max);
+
+    return maxScalar(data + i, size - i, maxScalar(lanes, 8, U32_MIN));
+}
+
+KERNEL_TARGET("avx2")
+static quint32 dotU32Avx2(const quint32 *a, const quint32 *b, int size)
+{
+    __m256i dot = _mm256_setzero_si256();
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8)
+        dot = _mm256_add_epi32(dot, _mm256_mullo_epi32(loadU32Avx2(a + i),
+                                                       loadU32Avx2(b + i)));
+
+    quint32 lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), dot);
+
+    return dotScalar(a + i, b + i, size - i, sumScalar(lanes, 8));
+}
+
+KERNEL_TARGET("avx2")
+static float sumF32Avx2(const float *data, int size)
+{
+    __m256 sum = _mm256_setzero_ps();
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8)
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(data + i));
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, sum);
+
+    return sumScalar(data + i, size - i, sumScalar(lanes, 8));
+}
+
+KERNEL_TARGET("avx2")
+static float minF32Avx2(const float *data, int size)
+{
+    __m256 min = _mm256_set1_ps(F32_MAX);
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8)
+        min = _mm256_min_ps(min, _mm256_loadu_ps(data + i));
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, min);
+
+    return minScalar(data + i, size - i, minScalar(lanes, 8, F32_MAX));
+}
+
+KERNEL_TARGET("avx2")
+static float maxF32Avx2(const float *data, int size)
+{
+    __m256 max = _mm256_set1_ps(F32_MIN);
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8)
+        max = _mm256_max_ps(max, _mm256_loadu_ps(data + i));
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, max);
+
+    return maxScalar(data + i, size - i, maxScalar(lanes, 8, F32_MIN));
+}
+
+KERNEL_TARGET("avx2,fma")
+static float dotF32Avx2(const float *a, const float *b, int size)
+{
+    __m256 dot = _mm256_setzero_ps();
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8)
+        dot = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),
+                              _mm256_loadu_ps(b + i),
+                              dot);
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, dot);
+
+    return dotScalar(a + i, b + i, size - i, sumScalar(lanes, 8));
+}
+
+KERNEL_TARGET("avx2")
+static void iotaI32Avx2(qint32 *dst, int size, qint32 start, qint32 step)
+{
+    __m256i value = _mm256_add_epi32(_mm256_set1_epi32(start),
+                                     _mm256_mullo_epi32(_mm256_set1_epi32(step),
+                                                        _mm256_setr_epi32(0, 1, 2, 3,
+                                                                          4, 5, 6, 7)));
+    __m256i increment = _mm256_set1_epi32(qint32(8 * quint32(step)));
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), value);
+        value = _mm256_add_epi32(value, increment);
+    }
+
+    iotaScalar(dst, size, start, step, i);
+}
+
+KERNEL_TARGET("avx2")
+static inline __m256i containsMaskAvx2(const qint32 *values,
+                                       __m256i start,
+                                       __m256i multiplier,
+                                       __m128i shiftRight,
+                                       __m128i shiftLeft,
+                                       __m256i count)
+{
+    const __m256i sign = _mm256_set1_epi32(std::numeric_limits<qint32>::min());
+    __m256i q = _mm256_mullo_epi32(_mm256_sub_epi32(loadU32Avx2(reinterpret_cast<const quint32 *>(values)),
+                                                    start),
+                                   multiplier);
+    q = _mm256_or_si256(_mm256_srl_epi32(q, shiftRight),
+                        _mm256_sll_epi32(q, shiftLeft));
+
+    return _mm256_cmpgt_epi32(_mm256_xor_si256(count, sign),
+                              _mm256_xor_si256(q, sign));
+}
+
+KERNEL_TARGET("avx2")
+static void containsI32Avx2(const qint32 *values,
+                            int size,
+                            const ContainsArgs &args,
+                            bool *out)
+{
+    __m256i start = _mm256_set1_epi32(args.start);
+    __m256i multiplier = _mm256_set1_epi32(qint32(args.multiplier));
+    __m128i shiftRight = _mm_cvtsi32_si128(args.shift);
+    __m128i shiftLeft = _mm_cvtsi32_si128(args.shift? 32 - args.shift: 32);
+    __m256i count = _mm256_set1_epi32(qint32(args.count));
+    __m128i one = _mm_set1_epi8(1);
+    int i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        __m256i a = containsMaskAvx2(values + i,
+                                     start,
+                                     multiplier,
+                                     shiftRight,
+                                     shiftLeft,
+                                     count);
+        __m256i b = containsMaskAvx2(values + i + 8,
+                                     start,
+                                     multiplier,
+                                     shiftRight,
+                                     shiftLeft,
+                                     count);
+
+        // The packs work within 128 bits lanes, so fix the order of the
+        // 64 bits blocks after every pack.
+        __m256i mask = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b),
+                                                _MM_SHUFFLE(3, 1, 2, 0));
+        mask = _mm256_permute4x64_epi64(_mm256_packs_epi16(mask, mask),
+                                        _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                         _mm_and_si128(_mm256_castsi256_si128(mask), one));
+    }
+
+    containsScalar(values, size, args, out, i);
+}
+
+KERNEL_TARGET("avx2")
+static void addF32Avx2(float *dst, const float *a, const float *b, int size)
+{
+    int i = alignmentHead(dst, size, 32);
+    addScalar(dst, a, b, i);
+
+    for (; i + 8 <= size; i += 8)
+        _mm256_store_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(a + i),
+                                               _mm256_loadu_ps(b + i)));
+
+    addScalar(dst, a, b, size, i);
+}
+
+KERNEL_TARGET("avx2")
+static void mulF32Avx2(float *dst, const float *a, const float *b, int size)
+{
+    int i = alignmentHead(dst, size, 32);
+    mulScalar(dst, a, b, i);
+
+    for (; i + 8 <= size; i += 8)
+        _mm256_store_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(a + i),
+                                               _mm256_loadu_ps(b + i)));
+
+    mulScalar(dst, a, b, size, i);
+}
+
+KERNEL_TARGET("avx2,fma")
+static void fmaF32Avx2(float *dst,
+                       const float *a,
+                       const float *b,
+                       const float *c,
+                       int size)
+{
+    int i = alignmentHead(dst, size, 32);
+    fmaScalar(dst, a, b, c, i);
+
+    for (; i + 8 <= size; i += 8)
+        _mm256_store_ps(dst + i, _mm256_fmadd_ps(_mm256_loadu_ps(a + i),
+                                                 _mm256_loadu_ps(b + i),
+                                                 _mm256_loadu_ps(c + i)));
+
+    fmaScalar(dst, a, b, c, size, i);
+}
+
+KERNEL_TARGET("avx2,fma")
+static void axpyF32Avx2(float *y, float alpha, const float *x, int size)
+{
+    __m256 valpha = _mm256_set1_ps(alpha);
+    int i = alignmentHead(y, size, 32);
+    axpyScalar(y, alpha, x, i);
+
+    for (; i + 8 <= size; i += 8)
+        _mm256_store_ps(y + i, _mm256_fmadd_ps(valpha,
+                                               _mm256_loadu_ps(x + i),
+                                               _mm256_load_ps(y + i)));
+
+    axpyScalar(y, alpha, x, size, i);
+}
+
+KERNEL_TARGET("avx2")
+static void clampF32Avx2(float *dst,
+                         const float *src,
+                         int size,
+                         float min,
+                         float max)
+{
+    __m256 vmin = _mm256_set1_ps(min);
+    __m256 vmax = _mm256_set1_ps(max);
+    int i = alignmentHead(dst, size, 32);
+    clampScalar(dst, src, min, max, i);
+
+    for (; i + 8 <= size; i += 8)
+        _mm256_store_ps(dst + i,
+                        _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + i),
+                                                    vmin),
+                                      vmax));
+
+    clampScalar(dst, src, min, max, size, i);
+}
+
+KERNEL_TARGET("avx2,fma")
+static void convertU32F32Avx2(float *dst, const quint32 *src, int size)
+{
+    const __m256i low = _mm256_set1_epi32(0xffff);
+    const __m256 scale = _mm256_set1_ps(65536.0f);
+    int i = alignmentHead(dst, size, 32);
+    convertScalar(dst, src, i);
+
+    for (; i + 8 <= size; i += 8) {
+        __m256i v = loadU32Avx2(src + i);
+        _mm256_store_ps(dst + i,
+                        _mm256_fmadd_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(v, 16)),
+                                        scale,
+                                        _mm256_cvtepi32_ps(_mm256_and_si256(v, low))));
+    }
+
+    convertScalar(dst, src, size, i);
+}
+
+static const KernelTable avx2Kernels = {
+    sumU32Avx2,
+    minU32Avx2,
+    maxU32Avx2,
+    dotU32Avx2,
+    sumF32Avx2,
+    minF32Avx2,
+    maxF32Avx2,
+    dotF32Avx2,
+    iotaI32Avx2,
+    containsI32Avx2,
+    addF32Avx2,
+    mulF32Avx2,
+    fmaF32Avx2,
+    axpyF32Avx2,
+    clampF32Avx2,
+    convertU32F32Avx2
+};
+
+// AVX-512 kernels.
+
+KERNEL_TARGET("avx512f")
+static quint32 sumU32Avx512(const quint32 *data, int size)
+{
+    __m512i sum = _mm512_setzero_si512();
+    int i = 0;
+
+    for (; i + 16 <= size; i += 16)
+        sum = _mm512_add_epi32(sum, _mm512_loadu_si512(data + i));
+
+    return sumScalar(data + i,
+                     size - i,
+                     quint32(_mm512_reduce_add_epi32(sum)));
+}
+
+KERNEL_TARGET("avx512f")
+static quint32 minU32Avx512(const quint32 *data, int size)
+{
+    __m512i min = _mm512_set1_epi32(-1);
+    int i = 0;
+
+    for (; i + 16 <= size; i += 16)
+        min = _mm512_min_epu32(min, _mm512_loadu_si512(data + i));
+
+    return minScalar(data + i,
+                     size - i,
+                     quint32(_mm512_reduce_min_epu32(min)));
+}
+
+KERNEL_TARGET("avx512f")
+static quint32 maxU32Avx512(const quint32 *data, int size)
+{
+    __m512i max = _mm512_setzero_si512();
+    int i = 0;
+
+    for (; i + 16 <= size; i += 16)
+        max = _mm512_max_epu32(max, _mm512_loadu_si512(data + i));
+
+    return maxScalar(data + i,
+                     size - i,
+                     quint32(_mm512_reduce_max_epu32(max)));
+}
+
+KERNEL_TARGET("avx512f")
+static quint32 dotU32Avx512(const quint32 *a, const quint32 *b, int size)
+{
+    __m512i dot = _mm512_setzero_si512();
+    int i = 0;
+
+    for (; i + 16 <= size; i += 16)
+        dot = _mm512_add_epi32(dot,
+                               _mm512_mullo_epi32(_mm512_loadu_si512(a + i),
+                                                  _mm512_loadu_si512(b + i)));
+
+    return dotScalar(a + i,
+                     b + i,
+                     size - i,
+                     quint32(_mm512_reduce_add_epi32(dot)));
+}
+
+KERNEL_TARGET("avx512f")
+static float sumF32Avx512(const float *data, int size)
+{
+    __m512 sum = _mm512_setzero_ps();
+    int i = 0;
+
+    for (; i + 16 <= size; i += 16)
+        sum = _mm512_add_ps(sum, _mm512_loadu_ps(data + i));
+
+    return sumScalar(data + i, size - i, _mm512_reduce_add_ps(sum));
+}
+
+KERNEL_TARGET("avx512f")
+static float minF32Avx512(const float *data, int size)
+{
+    __m512 min = _mm512_set1_ps(F32_MAX);
+    int i = 0;
+
+    for (; i + 16 <= size; i += 16)
+        min = _mm512_min_ps(min, _mm512_loadu_ps(data + i));
+
+    return minScalar(data + i, size - i, _mm512_reduce_min_ps(min));
+}
+
+KERNEL_TARGET("avx512f")
+static float maxF32Avx512(const float *data, int size)
+{
+    __m512 max = _mm512_set1_ps(F32_MIN);
+    int i = 0;
+
+    for (; i + 16 <= size; i += 16)
+        max = _mm512_max_ps(max, _mm512_loadu_ps(data + i));
+
+    return maxScalar(data + i, size - i, _mm512_reduce_max_ps(max));
+}
+
+KERNEL_TARGET("avx512f")
+static float dotF32Avx512(const float *a, const float *b, int size)
+{
+    __m512 dot = _mm512_setzero_ps();
+    int i = 0;
+
+    for (; i + 16 <= size; i += 16)
+        dot = _mm512_fmadd_ps(_mm512_loadu_ps(a + i),
+                              _mm512_loadu_ps(b + i),
+                              dot);
+
+    return dotScalar(a + i, b + i, size - i, _mm512_reduce_add_ps(dot));
+}
+
+KERNEL_TARGET("avx512f")
+static void iotaI32Avx512(qint32 *dst, int size, qint32 start, qint32 step)
+{
+    __m512i value =
+            _mm512_add_epi32(_mm512_set1_epi32(start),
+                             _mm512_mullo_epi32(_mm512_set1_epi32(step),
+                                                _mm512_setr_epi32(0, 1, 2, 3,
+                                                                  4, 5, 6, 7,
+                                                                  8, 9, 10, 11,
+                                                                  12, 13, 14, 15)));
+    __m512i increment = _mm512_set1_epi32(qint32(16 * quint32(step)));
+    int i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        _mm512_storeu_si512(dst + i, value);
+        value = _mm512_add_epi32(value, increment);
+    }
+
+    iotaScalar(dst, size, start, step, i);
+}
+
+KERNEL_TARGET("avx512f")
+static void containsI32Avx512(const qint32 *values,
+                              int size,
+                              const ContainsArgs &args,
+                              bool *out)
+{
+    __m512i start = _mm512_set1_epi32(args.start);
+    __m512i multiplier = _mm512_set1_epi32(qint32(args.multiplier));
+    __m512i shift = _mm512_set1_epi32(args.shift);
+    __m512i count = _mm512_set1_epi32(qint32(args.count));
+    __m512i one = _mm512_set1_epi32(1);
+    int i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        __m512i q = _mm512_mullo_epi32(_mm512_sub_epi32(_mm512_loadu_si512(values + i),
+                                                        start),
+                                       multiplier);
+        __mmask16 mask = _mm512_cmplt_epu32_mask(_mm512_rorv_epi32(q, shift),
+                                                 count);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                         _mm512_cvtepi32_epi8(_mm512_maskz_mov_epi32(mask, one)));
+    }
+
+    containsScalar(values, size, args, out, i);
+}
+
+KERNEL_TARGET("avx512f")
+static void addF32Avx512(float *dst, const float *a, const float *b, int size)
+{
+    int i = alignmentHead(dst, size, 64);
+    addScalar(dst, a, b, i);
+
+    for (; i + 16 <= size; i += 16)
+        _mm512_store_ps(dst + i, _mm512_add_ps(_mm512_loadu_ps(a + i),
+                                               _mm512_loadu_ps(b + i)));
+
+    addScalar(dst, a, b, size, i);
+}
+
+KERNEL_TARGET("avx512f")
+static void mulF32Avx512(float *dst, const float *a, const float *b, int size)
+{
+    int i = alignmentHead(dst, size, 64);
+    mulScalar(dst, a, b, i);
+
+    for (; i + 16 <= size; i += 16)
+        _mm512_store_ps(dst + i, _mm512_mul_ps(_mm512_loadu_ps(a + i),
+                                               _mm512_loadu_ps(b + i)));
+
+    mulScalar(dst, a, b, size, i);
+}
+
+KERNEL_TARGET("avx512f")
+static void fmaF32Avx512(float *dst,
+                         const float *a,
+                         const float *b,
+                         const float *c,
+                         int size)
+{
+    int i = alignmentHead(dst, size, 64);
+    fmaScalar(dst, a, b, c, i);
+
+    for (; i + 16 <= size; i += 16)
+        _mm512_store_ps(dst + i, _mm512_fmadd_ps(_mm512_loadu_ps(a + i),
+                                                 _mm512_loadu_ps(b + i),
+                                                 _mm512_loadu_ps(c + i)));
+
+    fmaScalar(dst, a, b, c, size, i);
+}
+
+KERNEL_TARGET("avx512f")
+static void axpyF32Avx512(float *y, float alpha, const float *x, int size)
+{
+    __m512 valpha = _mm512_set1_ps(alpha);
+    int i = alignmentHead(y, size, 64);
+    axpyScalar(y, alpha, x, i);
+
+    for (; i + 16 <= size; i += 16)
+        _mm512_store_ps(y + i, _mm512_fmadd_ps(valpha,
+                                               _mm512_loadu_ps(x + i),
+                                               _mm512_load_ps(y + i)));
+
+    axpyScalar(y, alpha, x, size, i);
+}
+
+KERNEL_TARGET("avx512f")
+static void clampF32Avx512(float *dst,
+                           const float *src,
+                           int size,
+                           float min,
+                           float max)
+{
+    __m512 vmin = _mm512_set1_ps(min);
+    __m512 vmax = _mm512_set1_ps(max);
+    int i = alignmentHead(dst, size, 64);
+    clampScalar(dst, src, min, max, i);
+
+    for (; i + 16 <= size; i += 16)
+        _mm512_store_ps(dst + i,
+                        _mm512_min_ps(_mm512_max_ps(_mm512_loadu_ps(src + i),
+                                                    vmin),
+                                      vmax));
+
+    clampScalar(dst, src, min, max, size, i);
+}
+
+KERNEL_TARGET("avx512f")
+static void convertU32F32Avx512(float *dst, const quint32 *src, int size)
+{
+    int i = alignmentHead(dst, size, 64);
+    convertScalar(dst, src, i);
+
+    for (; i + 16 <= size; i += 16)
+        _mm512_store_ps(dst + i, _mm512_cvtepu32_ps(_mm512_loadu_si512(src + i)));
+
+    convertScalar(dst, src, size, i);
+}
+
+static const KernelTable avx512Kernels = {
+    sumU32Avx512,
+    minU32Avx512,
+    maxU32Avx512,
+    dotU32Avx512,
+    sumF32Avx512,
+    minF32Avx512,
+    maxF32Avx512,
+    dotF32Avx512,
+    iotaI32Avx512,
+    containsI32Avx512,
+    addF32Avx512,
+    mulF32Avx512,
+    fmaF32Avx512,
+    axpyF32Avx512,
+    clampF32Avx512,
+    convertU32F32Avx512
+};
+
+#endif
+
+static bool kernelIsaSupported(KernelIsa isa)
+{
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+
+    switch (isa) {
+    case KernelIsaScalar:
+        return true;
+    case KernelIsaSSE2:
+        return __builtin_cpu_supports("sse2");
+    case KernelIsaAVX2:
+        return __builtin_cpu_supports("avx2")
+               && __builtin_cpu_supports("fma");
+    case KernelIsaAVX512:
+        return __builtin_cpu_supports("avx512f");
+    }
+
+    return false;
+#else
+    return isa == KernelIsaScalar;
+#endif
+}
+
+static const KernelTable *kernelTable(KernelIsa isa)
+{
+    switch (isa) {
+#ifdef KERNELS_X86
+    case KernelIsaSSE2:
+        return &sse2Kernels;
+    case KernelIsaAVX2:
+        return &avx2Kernels;
+    case KernelIsaAVX512:
+        return &avx512Kernels;
+#endif
+    default:
+        break;
+    }
+
+    return &scalarKernels;
+}
+
+static KernelIsa supportedIsa(KernelIsa isa)
+{
+    while (isa > KernelIsaScalar && !kernelIsaSupported(isa))
+        isa = KernelIsa(isa - 1);
+
+    return isa;
+}
+
+static KernelIsa currentIsa = supportedIsa(KernelIsaAVX512);
+static const KernelTable *kernels = kernelTable(currentIsa);
+
+// Whether the size elements of 4 bytes at dst and src overlap without being
+// the same elements.
+static inline bool partialOverlap(const void *dst, const void *src, int size)
+{
+    quintptr first = quintptr(dst);
+    quintptr other = quintptr(src);
+    quintptr bytes = quintptr(size) * 4;
+
+    return first != other && first < other + bytes && other < first + bytes;
+}
+
+// A vectorized kernel reads several elements ahead of the one it writes, so a
+// destination that partially overlaps a source would read values already
+// overwritten. Such calls run with the scalar kernels, element by element.
+static inline const KernelTable *elementwiseKernels(const void *dst,
+                                                    const void *a,
+                                                    const void *b,
+                                                    const void *c,
+                                                    int size)
+{
+    if (partialOverlap(dst, a, size)
+        || (b && partialOverlap(dst, b, size))
+        || (c && partialOverlap(dst, c, size)))
+        return &scalarKernels;
+
+    return kernels;
+}
+
+KernelIsa kernelIsa()
+{
+    return currentIsa;
+}
+
+KernelIsa kernelBestIsa()
+{
+    return supportedIsa(KernelIsaAVX512);
+}
+
+KernelIsa setKernelIsa(KernelIsa isa)
+{
+    currentIsa = supportedIsa(isa);
+    kernels = kernelTable(currentIsa);
+
+    return currentIsa;
+}
+
+const char *kernelIsaName(KernelIsa isa)
+{
+    switch (isa) {
+    case KernelIsaScalar:
+        return "scalar";
+    case KernelIsaSSE2:
+        return "SSE2";
+    case KernelIsaAVX2:
+        return "AVX2";
+    case KernelIsaAVX512:
+        return "AVX-512";
+    }
+
+    return "unknown";
+}
+
+quint32 kernelSum(const quint32 *data, int size)
+{
+    return kernels->sumU32(data, size);
+}
+
+quint32 kernelMin(const quint32 *data, int size)
+{
+    return kernels->minU32(data, size);
+}
+
+quint32 kernelMax(const quint32 *data, int size)
+{
+    return kernels->maxU32(data, size);
+}
+
+quint32 kernelDot(const quint32 *a, const quint32 *b, int size)
+{
+    return kernels->dotU32(a, b, size);
+}
+
+float kernelSum(const float *data, int size)
+{
+    return kernels->sumF32(data, size);
+}
+
+float kernelMin(const float *data, int size)
+{
+    return kernels->minF32(data, size);
+}
+
+float kernelMax(const float *data, int size)
+{
+    return kernels->maxF32(data, size);
+}
+
+float kernelDot(const float *a, const float *b, int size)
+{
+    return kernels->dotF32(a, b, size);
+}
+
+void kernelIota(RangeType *dst, int size, RangeType start, RangeType step)
+{
+    kernels->iotaI32(dst, size, start, step);
+}
+
+void kernelContainsMany(const Range &range,
+                        const RangeType *values,
+                        int size,
+                        bool *out)
+{
+    quint32 step = range.step() < 0?
+                       0 - quint32(range.step()):
+                       quint32(range.step());
+    RangeDivisor<quint32> divisor(step);
+    ContainsArgs args;
+    args.start = range.start();
+    args.multiplier = range.step() < 0?
+                          0 - divisor.inverse():
+                          divisor.inverse();
+    args.shift = divisor.shift();
+    args.count = quint32(range.size());
+
+    kernels->containsI32(values, size, args, out);
+}
+
+void kernelAdd(float *dst, const float *a, const float *b, int size)
+{
+    elementwiseKernels(dst, a, b, nullptr, size)->addF32(dst, a, b, size);
+}
+
+void kernelMul(float *dst, const float *a, const float *b, int size)
+{
+    elementwiseKernels(dst, a, b, nullptr, size)->mulF32(dst, a, b, size);
+}
+
+void kernelFma(float *dst,
+               const float *a,
+               const float *b,
+               const float *c,
+               int size)
+{
+    elementwiseKernels(dst, a, b, c, size)->fmaF32(dst, a, b, c, size);
+}
+
+void kernelAxpy(float *y, float alpha, const float *x, int size)
+{
+    elementwiseKernels(y, x, nullptr, nullptr, size)->axpyF32(y, alpha, x, size);
+}
+
+void kernelClamp(float *dst, const float *src, int size, float min, float max)
+{
+    elementwiseKernels(dst, src, nullptr, nullptr, size)->clampF32(dst,
+                                                                   src,
+                                                                   size,
+                                                                   min,
+                                                                   max);
+}
+
+void kernelConvert(float *dst, const quint32 *src, int size)
+{
+    elementwiseKernels(dst, src, nullptr, nullptr, size)->convertU32F32(dst,
+                                                                        src,
+                                                                        size);
+}
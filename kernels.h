@@ -0,0 +1,290 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include "range.h"
+
+// Instruction sets the kernels are implemented for.
+enum KernelIsa
+{
+    KernelIsaScalar,
+    KernelIsaSSE2,
+    KernelIsaAVX2,
+    KernelIsaAVX512
+};
+
+// The best instruction set supported by the CPU is selected at startup.
+KernelIsa kernelIsa();
+KernelIsa kernelBestIsa();
+
+// Forces the kernels to use the given instruction set, or the best one below
+// it supported by the CPU. Returns the instruction set actually selected.
+// This is meant for testing and benchmarking, don't call it while kernels are
+// running in other threads.
+KernelIsa setKernelIsa(KernelIsa isa);
+const char *kernelIsaName(KernelIsa isa);
+
+// Reductions over contiguous buffers. Integer results wrap around exactly as
+// the scalar loop does. min() and max() of an empty buffer return the
+// identity of the operation (the largest and the smallest value of the type).
+quint32 kernelSum(const quint32 *data, int size);
+quint32 kernelMin(const quint32 *data, int size);
+quint32 kernelMax(const quint32 *data, int size);
+quint32 kernelDot(const quint32 *a, const quint32 *b, int size);
+float kernelSum(const float *data, int size);
+float kernelMin(const float *data, int size);
+float kernelMax(const float *data, int size);
+float kernelDot(const float *a, const float *b, int size);
+
+// Writes start, start + step, start + 2 * step... in dst, wrapping around on
+// overflow as the Range elements do.
+void kernelIota(RangeType *dst, int size, RangeType start, RangeType step);
+
+// Writes in out[i] whether values[i] is in range, same as
+// Range::containsMany() but vectorized.
+void kernelContainsMany(const Range &range,
+                        const RangeType *values,
+                        int size,
+                        bool *out);
+
+// Elementwise operations over contiguous float buffers, dst may be the same
+// buffer as any of the sources. Buffers that partially overlap are checked
+// once per call and processed one element at a time.
+// dst = a + b.
+void kernelAdd(float *dst, const float *a, const float *b, int size);
+
+// dst = a * b.
+void kernelMul(float *dst, const float *a, const float *b, int size);
+
+// dst = a * b + c, the product isn't rounded on AVX2 and AVX-512.
+void kernelFma(float *dst,
+               const float *a,
+               const float *b,
+               const float *c,
+               int size);
+
+// y = alpha * x + y, the product isn't rounded on AVX2 and AVX-512.
+void kernelAxpy(float *y, float alpha, const float *x, int size);
+
+// Bounds src to [min, max], NaN values give min.
+void kernelClamp(float *dst, const float *src, int size, float min, float max);
+
+// Converts src to float, rounding to nearest like the scalar conversion.
+void kernelConvert(float *dst, const quint32 *src, int size);
+
+// Reductions over the elements of buffer indexed by range, these are meant to
+// be called on the blocks given by parallelBlockReduce() and friends.
+// Ranges with step 1 go through the vectorized kernels.
+template <typename T>
+T kernelSum(const QVector<T> &buffer, const Range &range)
+{
+    if (range.step() == 1)
+        return kernelSum(buffer.constData() + range.start(), int(range.size()));
+
+    T sum = 0;
+
+    for (int i: range)
+        sum += buffer[i];
+
+    return sum;
+}
+
+template <typename T>
+T kernelMin(const QVector<T> &buffer, const Range &range)
+{
+    if (range.step() == 1)
+        return kernelMin(buffer.constData() + range.start(), int(range.size()));
+
+    T min = kernelMin(static_cast<const T *>(nullptr), 0);
+
+    for (int i: range)
+        min = qMin(min, buffer[i]);
+
+    return min;
+}
+
+template <typename T>
+T kernelMax(const QVector<T> &buffer, const Range &range)
+{
+    if (range.step() == 1)
+        return kernelMax(buffer.constData() + range.start(), int(range.size()));
+
+    T max = kernelMax(static_cast<const T *>(nullptr), 0);
+
+    for (int i: range)
+        max = qMax(max, buffer[i]);
+
+    return max;
+}
+
+template <typename T>
+T kernelDot(const QVector<T> &a, const QVector<T> &b, const Range &range)
+{
+    if (range.step() == 1)
+        return kernelDot(a.constData() + range.start(),
+                         b.constData() + range.start(),
+                         int(range.size()));
+
+    T dot = 0;
+
+    for (int i: range)
+        dot += a[i] * b[i];
+
+    return dot;
+}
+
+// Elementwise operations over the elements of the buffers indexed by range,
+// these are meant to be called on the chunks given by parallelFor(), so dst
+// must be detached before the loop, not from several threads at once.
+// Ranges with step 1 go through the vectorized kernels.
+inline void kernelAdd(QVector<float> &dst,
+                      const QVector<float> &a,
+                      const QVector<float> &b,
+                      const Range &range)
+{
+    Q_ASSERT(dst.isDetached());
+    float *out = dst.data();
+
+    if (range.step() == 1) {
+        kernelAdd(out + range.start(),
+                  a.constData() + range.start(),
+                  b.constData() + range.start(),
+                  int(range.size()));
+
+        return;
+    }
+
+    for (int i: range)
+        out[i] = a[i] + b[i];
+}
+
+inline void kernelMul(QVector<float> &dst,
+                      const QVector<float> &a,
+                      const QVector<float> &b,
+                      const Range &range)
+{
+    Q_ASSERT(dst.isDetached());
+    float *out = dst.data();
+
+    if (range.step() == 1) {
+        kernelMul(out + range.start(),
+                  a.constData() + range.start(),
+                  b.constData() + range.start(),
+                  int(range.size()));
+
+        return;
+    }
+
+    for (int i: range)
+        out[i] = a[i] * b[i];
+}
+
+inline void kernelFma(QVector<float> &dst,
+                      const QVector<float> &a,
+                      const QVector<float> &b,
+                      const QVector<float> &c,
+                      const Range &range)
+{
+    Q_ASSERT(dst.isDetached());
+    float *out = dst.data();
+
+    if (range.step() == 1) {
+        kernelFma(out + range.start(),
+                  a.constData() + range.start(),
+                  b.constData() + range.start(),
+                  c.constData() + range.start(),
+                  int(range.size()));
+
+        return;
+    }
+
+    for (int i: range)
+        out[i] = a[i] * b[i] + c[i];
+}
+
+inline void kernelAxpy(QVector<float> &y,
+                       float alpha,
+                       const QVector<float> &x,
+                       const Range &range)
+{
+    Q_ASSERT(y.isDetached());
+    float *out = y.data();
+
+    if (range.step() == 1) {
+        kernelAxpy(out + range.start(),
+                   alpha,
+                   x.constData() + range.start(),
+                   int(range.size()));
+
+        return;
+    }
+
+    for (int i: range)
+        out[i] += alpha * x[i];
+}
+
+inline void kernelClamp(QVector<float> &dst,
+                        const QVector<float> &src,
+                        float min,
+                        float max,
+                        const Range &range)
+{
+    Q_ASSERT(dst.isDetached());
+    float *out = dst.data();
+
+    if (range.step() == 1) {
+        kernelClamp(out + range.start(),
+                    src.constData() + range.start(),
+                    int(range.size()),
+                    min,
+                    max);
+
+        return;
+    }
+
+    for (int i: range) {
+        float value = src[i] > min? src[i]: min;
+        out[i] = value < max? value: max;
+    }
+}
+
+inline void kernelConvert(QVector<float> &dst,
+                          const QVector<quint32> &src,
+                          const Range &range)
+{
+    Q_ASSERT(dst.isDetached());
+    float *out = dst.data();
+
+    if (range.step() == 1) {
+        kernelConvert(out + range.start(),
+                      src.constData() + range.start(),
+                      int(range.size()));
+
+        return;
+    }
+
+    for (int i: range)
+        out[i] = float(src[i]);
+}
+
+#endif // KERNELS_H
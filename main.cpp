@@ -19,10 +19,15 @@
  * Web-Site: http://github.com/hipersayanX/QtRangeExample
  */
 
+#include <QCommandLineParser>
 #include <QCoreApplication>
 #include <QtConcurrent>
 
-#include "range.h"
+#include "histogram.h"
+#include "kernels.h"
+#include "mapped.h"
+#include "parallel.h"
+#include "pipeline.h"
 
 #define BUFFERSIZE (3 * 7 * 11 * 13 * 17 * 19 * 23)
 
@@ -31,31 +36,44 @@ QVector<float> bufferB(BUFFERSIZE);
 QVector<float> bufferC(BUFFERSIZE);
 
 QVector<quint32> bufferI(BUFFERSIZE);
-QVector<quint32> bufferO(BUFFERSIZE);
-quint32 *bufferP[2] = {bufferI.data(), bufferO.data()};
-int inBufferSize;
-int outBufferSize;
-int buffN = 0;
-
-void sum(int i)
-{
-    int next = 2 * i + 1;
-
-    if (next < inBufferSize)
-        bufferP[1 - buffN][i] = bufferP[buffN][2 * i] + bufferP[buffN][next];
-    else
-        bufferP[1 - buffN][i] = bufferP[buffN][2 * i];
-}
-
-inline int outSize(int inSize)
-{
-    return (inSize + (inSize & 0x1)) / 2;
-}
 
 int main(int argc, char *argv[])
 {
     QCoreApplication a(argc, argv);
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Sums a buffer of random values, or the "
+                                     "values of a binary file.");
+    parser.addHelpOption();
+    QCommandLineOption floatOption("float",
+                                   "The file holds float values instead of "
+                                   "quint32.");
+    parser.addOption(floatOption);
+    parser.addPositionalArgument("file",
+                                 "Binary file to sum, it's memory mapped so "
+                                 "it can be bigger than the memory.",
+                                 "[file]");
+    parser.process(a);
+
+    if (!parser.positionalArguments().isEmpty()) {
+        QString fileName = parser.positionalArguments().first();
+        QElapsedTimer timer;
+        timer.start();
+        bool ok = false;
+
+        if (parser.isSet(floatOption)) {
+            float sum = 0;
+            ok = mappedSum(fileName, &sum);
+            qDebug() << sum << timer.elapsed();
+        } else {
+            quint32 sum = 0;
+            ok = mappedSum(fileName, &sum);
+            qDebug() << sum << timer.elapsed();
+        }
+
+        return ok? 0: 1;
+    }
+
     // Inicialize buffer
     for (int i = 0; i < BUFFERSIZE; i++)
         bufferI[i] = qrand() % 128;
@@ -73,18 +91,77 @@ int main(int argc, char *argv[])
 
     timer.restart();
 
-    // Concurrent prefix sum.
-    for (inBufferSize = BUFFERSIZE,
-         outBufferSize = outSize(inBufferSize);
-         inBufferSize > 1;
-         inBufferSize = outBufferSize,
-         outBufferSize = outSize(inBufferSize)) {
-        Range range(outBufferSize);
-        QtConcurrent::blockingMap(range, sum);
-        buffN = 1 - buffN;
-    }
+    // Concurrent sum.
+    const quint32 *in = bufferI.constData();
+
+    quint32 sumP = parallelReduce(Range(BUFFERSIZE),
+                                  quint32(0),
+                                  [in] (int i) {
+                                      return in[i];
+                                  },
+                                  [] (quint32 a, quint32 b) {
+                                      return a + b;
+                                  });
+
+    qDebug() << sumP << timer.elapsed();
+
+    timer.restart();
+
+    // Concurrent vectorized sum.
+    auto sumBlock = [] (const Range &block) {
+        return kernelSum(bufferI, block);
+    };
+
+    quint32 sumV = parallelBlockReduce<quint32>(Range(BUFFERSIZE),
+                                                sumBlock,
+                                                [] (quint32 a, quint32 b) {
+                                                    return a + b;
+                                                });
+
+    qDebug() << sumV << timer.elapsed() << kernelIsaName(kernelIsa());
+
+    timer.restart();
+
+    // Concurrent sum of the odd values, map and filter run fused in a single
+    // loop per thread.
+    quint32 sumF = Range(BUFFERSIZE)
+                   .map([in] (int i) {
+                       return in[i];
+                   })
+                   .filter([] (quint32 value) {
+                       return value & 0x1;
+                   })
+                   .reduce(quint32(0), [] (quint32 a, quint32 b) {
+                       return a + b;
+                   });
+
+    qDebug() << sumF << timer.elapsed();
+
+    timer.restart();
+
+    // Concurrent histogram of the values, every thread counts in its own bins.
+    QVector<qint64> histogram = parallelHistogram(Range(BUFFERSIZE),
+                                                  [in] (int i) {
+                                                      return int(in[i]);
+                                                  },
+                                                  128);
+
+    qDebug() << histogram.first() << histogram.last() << timer.elapsed();
+
+    timer.restart();
+
+    // Concurrent vectorized elementwise kernels, every chunk converts the
+    // values to float and computes C = 2 * A + B with A the converted values.
+    for (int i = 0; i < BUFFERSIZE; i++)
+        bufferB[i] = float(i % 64) / 64;
+
+    parallelFor(Range(BUFFERSIZE), [] (const Range &chunk) {
+        kernelConvert(bufferA, bufferI, chunk);
+        kernelAdd(bufferC, bufferA, bufferB, chunk);
+        kernelAxpy(bufferC, 1.0f, bufferA, chunk);
+    });
 
-    qDebug() << bufferP[buffN][0] << timer.elapsed();
+    qDebug() << kernelSum(bufferC, Range(BUFFERSIZE)) << timer.elapsed();
 
     return 0;
 }
@@ -0,0 +1,161 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "mapped.h"
+
+enum MappedAdvice
+{
+    MappedAdviceSequential,
+    MappedAdviceWillNeed
+};
+
+static qint64 pageSize()
+{
+#ifdef Q_OS_UNIX
+    static const qint64 size = qMax<qint64>(sysconf(_SC_PAGESIZE), 1);
+#else
+    static const qint64 size = 4096;
+#endif
+
+    return size;
+}
+
+static void advise(const uchar *data, qint64 bytes, MappedAdvice advice)
+{
+#ifdef Q_OS_UNIX
+    // madvise() takes page aligned addresses.
+    quintptr start = quintptr(data) & ~quintptr(pageSize() - 1);
+    size_t length = size_t(quintptr(data) + quintptr(bytes) - start);
+    madvise(reinterpret_cast<void *>(start),
+            length,
+            advice == MappedAdviceSequential? MADV_SEQUENTIAL: MADV_WILLNEED);
+#else
+    Q_UNUSED(data)
+    Q_UNUSED(bytes)
+    Q_UNUSED(advice)
+#endif
+}
+
+MappedReader::MappedReader(const QString &fileName, qint64 window):
+    m_file(fileName)
+{
+    // Windows start at multiples of the page size, so they are mapped
+    // without padding.
+    qint64 page = pageSize();
+    this->m_window = qMax(page, (window + page - 1) / page * page);
+}
+
+MappedReader::~MappedReader()
+{
+}
+
+QString MappedReader::errorString() const
+{
+    return this->m_errorString;
+}
+
+QString MappedReader::fileName() const
+{
+    return this->m_file.fileName();
+}
+
+bool MappedReader::forEachWindow(qint64 alignment,
+                                 const std::function<void (qint64 offset,
+                                                           const uchar *data,
+                                                           qint64 bytes)> &function)
+{
+    if (!this->m_file.open(QIODevice::ReadOnly)) {
+        this->m_errorString = this->m_file.errorString();
+
+        return false;
+    }
+
+    alignment = qMax<qint64>(alignment, 1);
+
+    // The window must hold whole values.
+    qint64 window = this->m_window / alignment * alignment;
+
+    if (window < 1)
+        window = alignment;
+
+    qint64 size = this->m_file.size();
+    size -= size % alignment;
+    bool ok = true;
+    qint64 bytes = qMin(window, size);
+    const uchar *data = bytes > 0? this->mapWindow(0, bytes): nullptr;
+
+    if (bytes > 0 && !data)
+        ok = false;
+
+    for (qint64 offset = 0; ok && offset < size; offset += window) {
+        qint64 nextOffset = offset + window;
+        qint64 nextBytes = qMin(window, size - nextOffset);
+        const uchar *next = nullptr;
+
+        // Map the next window before working on this one, so the kernel
+        // reads it ahead while the threads are busy.
+        if (nextBytes > 0) {
+            next = this->mapWindow(nextOffset, nextBytes);
+
+            if (next)
+                advise(next, nextBytes, MappedAdviceWillNeed);
+            else
+                ok = false;
+        }
+
+        function(offset, data, bytes);
+        this->m_file.unmap(const_cast<uchar *>(data));
+        data = next;
+        bytes = nextBytes;
+    }
+
+    if (data)
+        this->m_file.unmap(const_cast<uchar *>(data));
+
+    this->m_file.close();
+
+    return ok;
+}
+
+qint64 MappedReader::window() const
+{
+    return this->m_window;
+}
+
+const uchar *MappedReader::mapWindow(qint64 offset, qint64 bytes)
+{
+    const uchar *data = this->m_file.map(offset, bytes);
+
+    if (!data) {
+        this->m_errorString = this->m_file.errorString();
+
+        return nullptr;
+    }
+
+    advise(data, bytes, MappedAdviceSequential);
+
+    return data;
+}
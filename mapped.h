@@ -0,0 +1,125 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef MAPPED_H
+#define MAPPED_H
+
+#include <functional>
+#include <QFile>
+
+#include "kernels.h"
+#include "parallel.h"
+
+// Bytes of the file mapped at once. Files of any size are read through two
+// windows of this size, so they don't need to fit in memory or, on 32 bits
+// systems, in the address space.
+#define MAPPED_WINDOW (Q_INT64_C(256) << 20)
+
+// Reads a file as consecutive memory mapped windows.
+class MappedReader
+{
+    public:
+        explicit MappedReader(const QString &fileName,
+                              qint64 window=MAPPED_WINDOW);
+        ~MappedReader();
+
+        QString errorString() const;
+        QString fileName() const;
+
+        // Calls function(offset, data, bytes) for consecutive windows of the
+        // file, in order, with bytes a multiple of alignment. Trailing bytes
+        // that don't fill a whole alignment are skipped.
+        // Every window is marked for sequential access, and the next one is
+        // mapped and prefetched while function runs over the current one.
+        // Returns false if the file can't be opened or mapped.
+        bool forEachWindow(qint64 alignment,
+                           const std::function<void (qint64 offset,
+                                                     const uchar *data,
+                                                     qint64 bytes)> &function);
+        qint64 window() const;
+
+    private:
+        QFile m_file;
+        qint64 m_window;
+        QString m_errorString;
+
+        const uchar *mapWindow(qint64 offset, qint64 bytes);
+
+        Q_DISABLE_COPY(MappedReader)
+};
+
+// Reduces the values of type T stored in the binary file fileName, in the
+// byte order of the machine, without copying them: every window of the file
+// is reduced in parallel with reduceBlock(const T *data, int size), and the
+// partial results combined with combine(a, b).
+// An empty file gives reduceBlock(nullptr, 0). Returns false, leaving result
+// untouched, if the file can't be read.
+template <typename T, typename BlockFunction, typename CombineFunction>
+bool mappedBlockReduce(const QString &fileName,
+                       BlockFunction reduceBlock,
+                       CombineFunction combine,
+                       T *result,
+                       qint64 window=MAPPED_WINDOW)
+{
+    // Every window must fit in a Range.
+    MappedReader reader(fileName, qMin<qint64>(window, Q_INT64_C(1) << 30));
+    T accumulator = reduceBlock(static_cast<const T *>(nullptr), 0);
+    bool first = true;
+
+    auto reduceWindow = [&] (qint64 offset, const uchar *data, qint64 bytes) {
+        Q_UNUSED(offset)
+        auto values = reinterpret_cast<const T *>(data);
+        int size = int(bytes / qint64(sizeof(T)));
+        T partial =
+                parallelBlockReduce<T>(Range(size),
+                                       [values, &reduceBlock] (const Range &block) {
+            return reduceBlock(values + block.start(), int(block.size()));
+        }, combine);
+        accumulator = first? partial: combine(accumulator, partial);
+        first = false;
+    };
+
+    if (!reader.forEachWindow(sizeof(T), reduceWindow)) {
+        qWarning() << "Can't read" << fileName << reader.errorString();
+
+        return false;
+    }
+
+    *result = accumulator;
+
+    return true;
+}
+
+// Sums a file of quint32 or float values with the vectorized kernels.
+template <typename T>
+bool mappedSum(const QString &fileName,
+               T *sum,
+               qint64 window=MAPPED_WINDOW)
+{
+    return mappedBlockReduce<T>(fileName,
+                                [] (const T *data, int size) {
+        return kernelSum(data, size);
+    }, [] (T a, T b) {
+        return a + b;
+    }, sum, window);
+}
+
+#endif // MAPPED_H
@@ -0,0 +1,230 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef PAIRWISE_H
+#define PAIRWISE_H
+
+#include "parallel.h"
+#include "reduction.h"
+
+// Elements of the leaves of the summation tree. The leaves depend only on
+// the size of the range, never on the number of threads.
+#define PAIRWISE_LEAF 4096
+
+// Interleaved accumulators every leaf is summed with, so the additions of a
+// leaf don't wait for each other.
+#define PAIRWISE_LANES 8
+
+enum PairwiseCompensation
+{
+    PairwiseCompensationNone,
+    PairwiseCompensationKahan,
+    PairwiseCompensationNeumaier
+};
+
+// A partial sum, its value is sum + compensation.
+template <typename T>
+struct PairwisePartial
+{
+    T sum;
+    T compensation;
+};
+
+// Adds two partial sums, keeping the rounding error of the addition when
+// compensating (Knuth's TwoSum, exact for any magnitudes).
+template <typename T>
+inline PairwisePartial<T> pairwiseCombine(const PairwisePartial<T> &a,
+                                          const PairwisePartial<T> &b,
+                                          PairwiseCompensation compensation)
+{
+    T sum = a.sum + b.sum;
+
+    if (compensation == PairwiseCompensationNone)
+        return {sum, T(0)};
+
+    T bVirtual = sum - a.sum;
+    T aVirtual = sum - bVirtual;
+    T error = (a.sum - aVirtual) + (b.sum - bVirtual);
+
+    return {sum, a.compensation + b.compensation + error};
+}
+
+template <typename T, PairwiseCompensation Compensation>
+inline void pairwiseAdd(T &sum, T &compensation, T value)
+{
+    if (Compensation == PairwiseCompensationKahan) {
+        T y = value + compensation;
+        T t = sum + y;
+        compensation = y - (t - sum);
+        sum = t;
+    } else if (Compensation == PairwiseCompensationNeumaier) {
+        T t = sum + value;
+        compensation += qAbs(sum) >= qAbs(value)?
+                            (sum - t) + value:
+                            (value - t) + sum;
+        sum = t;
+    } else {
+        sum += value;
+    }
+}
+
+// Sums the leaf [first, last) of the positions of range, element i goes to
+// the accumulator i % PAIRWISE_LANES, and the accumulators are added as a
+// balanced tree. Leaves start at multiples of PAIRWISE_LEAF, so the lanes
+// are the same as the positions in the leaf modulo PAIRWISE_LANES.
+template <typename T, PairwiseCompensation Compensation>
+PairwisePartial<T> pairwiseLeaf(const T *data,
+                                const Range &range,
+                                qint64 first,
+                                qint64 last)
+{
+    T sums[PAIRWISE_LANES];
+    T compensations[PAIRWISE_LANES];
+
+    for (int lane = 0; lane < PAIRWISE_LANES; lane++) {
+        sums[lane] = T(0);
+        compensations[lane] = T(0);
+    }
+
+    qint64 i = first;
+
+    if (range.step() == 1) {
+        const T *values = data + range.start();
+
+        // The lanes are independent, so the compiler is free to vectorize
+        // this loop without changing the result.
+        for (; i + PAIRWISE_LANES <= last; i += PAIRWISE_LANES)
+            for (int lane = 0; lane < PAIRWISE_LANES; lane++)
+                pairwiseAdd<T, Compensation>(sums[lane],
+                                             compensations[lane],
+                                             values[i + lane]);
+
+        for (; i < last; i++)
+            pairwiseAdd<T, Compensation>(sums[i % PAIRWISE_LANES],
+                                         compensations[i % PAIRWISE_LANES],
+                                         values[i]);
+    } else {
+        for (; i < last; i++)
+            pairwiseAdd<T, Compensation>(sums[i % PAIRWISE_LANES],
+                                         compensations[i % PAIRWISE_LANES],
+                                         data[range.at(i)]);
+    }
+
+    PairwisePartial<T> lanes[PAIRWISE_LANES];
+
+    for (int lane = 0; lane < PAIRWISE_LANES; lane++)
+        lanes[lane] = {sums[lane], compensations[lane]};
+
+    for (int width = 1; width < PAIRWISE_LANES; width *= 2)
+        for (int lane = 0; lane + width < PAIRWISE_LANES; lane += 2 * width)
+            lanes[lane] = pairwiseCombine(lanes[lane],
+                                          lanes[lane + width],
+                                          Compensation);
+
+    return lanes[0];
+}
+
+template <typename T>
+PairwisePartial<T> pairwiseLeaf(const T *data,
+                                const Range &range,
+                                qint64 first,
+                                qint64 last,
+                                PairwiseCompensation compensation)
+{
+    switch (compensation) {
+    case PairwiseCompensationKahan:
+        return pairwiseLeaf<T, PairwiseCompensationKahan>(data, range, first, last);
+    case PairwiseCompensationNeumaier:
+        return pairwiseLeaf<T, PairwiseCompensationNeumaier>(data, range, first, last);
+    default:
+        break;
+    }
+
+    return pairwiseLeaf<T, PairwiseCompensationNone>(data, range, first, last);
+}
+
+// Adds the partial sums of the leaves [first, last), splitting them in
+// halves down to single leaves.
+template <typename T>
+PairwisePartial<T> pairwiseTree(const PairwisePartial<T> *leaves,
+                                qint64 first,
+                                qint64 last,
+                                PairwiseCompensation compensation)
+{
+    if (last - first < 2)
+        return leaves[first];
+
+    qint64 middle = first + (last - first) / 2;
+
+    return pairwiseCombine(pairwiseTree(leaves, first, middle, compensation),
+                           pairwiseTree(leaves, middle, last, compensation),
+                           compensation);
+}
+
+// Sums the elements of buffer indexed by range in the global thread pool,
+// with a result that is the same to the last bit for any number of threads
+// and any scheduling.
+// The positions of the range are cut in leaves of PAIRWISE_LEAF elements,
+// every leaf is summed in a fixed order, and the sums of the leaves are added
+// pairwise over a tree whose shape depends only on the size of the range.
+// The threads only decide who sums which leaves. The error grows with the
+// logarithm of the size instead of linearly, and the compensated modes also
+// carry the rounding error of every addition, to within a few ulps of the
+// exact sum. The partial sums of the leaves live in the scratch of context,
+// pass one to reuse them between calls.
+template <typename T>
+T pairwiseSum(const QVector<T> &buffer,
+              const Range &range,
+              PairwiseCompensation compensation=PairwiseCompensationNone,
+              ReductionContext *context=nullptr)
+{
+    qint64 size = range.size();
+
+    if (size < 1)
+        return T(0);
+
+    ReductionContext localContext;
+
+    if (!context)
+        context = &localContext;
+
+    qint64 leafCount = (size + PAIRWISE_LEAF - 1) / PAIRWISE_LEAF;
+    auto leaves = context->scratch<PairwisePartial<T>>(0, leafCount);
+    const T *data = buffer.constData();
+    qint64 grain = qMax<qint64>(1, parallelGrain(size) / PAIRWISE_LEAF);
+
+    parallelFor(BasicRange<qint64>(0, leafCount),
+                grain,
+                [&] (const BasicRange<qint64> &chunk) {
+        for (qint64 leaf: chunk)
+            leaves[leaf] = pairwiseLeaf(data,
+                                        range,
+                                        leaf * PAIRWISE_LEAF,
+                                        qMin(size, (leaf + 1) * PAIRWISE_LEAF),
+                                        compensation);
+    });
+
+    PairwisePartial<T> sum = pairwiseTree(leaves, 0, leafCount, compensation);
+
+    return sum.sum + sum.compensation;
+}
+
+#endif // PAIRWISE_H
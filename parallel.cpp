@@ -0,0 +1,86 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#include "kernels.h"
+#include "parallel.h"
+
+// Chunks smaller than this are not worth sending to another thread.
+#define MIN_GRAIN 1024
+
+// Every thread gets this number of chunks, so the threads that finish earlier
+// can take the remaining work.
+#define CHUNKS_PER_THREAD 4
+
+// Below this number of elements a fill is faster in the calling thread.
+#define PARALLEL_FILL_THRESHOLD (1 << 18)
+
+// The biggest buffer the kernels take in a single call.
+#define KERNEL_MAX_SIZE std::numeric_limits<int>::max()
+
+qint64 parallelGrain(qint64 size, int threads)
+{
+    qint64 chunks = CHUNKS_PER_THREAD * qMax(threads, 1);
+    qint64 grain = (size + chunks - 1) / chunks;
+
+    return qMax<qint64>(grain, MIN_GRAIN);
+}
+
+void parallelFillInto(const Range &range, RangeType *dst)
+{
+    qint64 size = range.size();
+
+    // Split the indexes rather than the range, the start of every block is
+    // its offset in dst. A Range can have up to 2^32 elements, more than the
+    // kernel takes at once.
+    BasicRange<qint64> indexes(0, size);
+    QVector<BasicRange<qint64>> blocks =
+            size < PARALLEL_FILL_THRESHOLD?
+                indexes.chunks(size):
+                indexes.split(QThreadPool::globalInstance()->maxThreadCount());
+
+    auto fillBlock = [&range, dst] (const BasicRange<qint64> &block) {
+        TRACE_SCOPE("parallelFillInto", block.size());
+
+        for (qint64 i = block.start(); i < block.stop(); i += KERNEL_MAX_SIZE)
+            kernelIota(dst + i,
+                       int(qMin<qint64>(block.stop() - i, KERNEL_MAX_SIZE)),
+                       range.at(i),
+                       range.step());
+    };
+
+    if (blocks.size() < 2) {
+        for (const BasicRange<qint64> &block: blocks)
+            fillBlock(block);
+
+        return;
+    }
+
+    QtConcurrent::blockingMap(blocks, fillBlock);
+}
+
+void parallelFillInto(const Range &range, QVector<RangeType> &dst)
+{
+    Q_ASSERT_X(range.size() <= std::numeric_limits<int>::max(),
+               "parallelFillInto",
+               "the range doesn't fit in a QVector");
+    dst.resize(int(range.size()));
+    parallelFillInto(range, dst.data());
+}
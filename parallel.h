@@ -0,0 +1,151 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include "range.h"
+#include "trace.h"
+
+// Returns a grain size that gives every thread of the pool a few chunks to
+// work on, without making the chunks so small that the scheduling cost
+// dominates the work done in them.
+qint64 parallelGrain(qint64 size,
+                     int threads=QThreadPool::globalInstance()->maxThreadCount());
+
+// Runs function(const BasicRange<R> &chunk) over consecutive chunks of range
+// in the global thread pool, so every worker loops over a contiguous block of
+// indices instead of receiving them one by one.
+// If grain < 1, it will be calculated with parallelGrain(). Ranges with more
+// elements than fit in an int, like BasicRange<qint64>, are fine as long as
+// the grain keeps the number of chunks below that.
+template <typename Function, typename R>
+void parallelFor(const BasicRange<R> &range, qint64 grain, Function function)
+{
+    if (grain < 1)
+        grain = parallelGrain(range.size());
+
+    QVector<BasicRange<R>> chunks = range.chunks(grain);
+
+    if (chunks.size() < 2) {
+        for (const BasicRange<R> &chunk: chunks) {
+            TRACE_SCOPE("parallelFor", chunk.size());
+            function(chunk);
+        }
+
+        return;
+    }
+
+    QtConcurrent::blockingMap(chunks, [&function] (BasicRange<R> &chunk) {
+        TRACE_SCOPE("parallelFor", chunk.size());
+        function(chunk);
+    });
+}
+
+template <typename Function, typename R>
+void parallelFor(const BasicRange<R> &range, Function function)
+{
+    parallelFor(range, 0, function);
+}
+
+// Writes the elements of range in dst with the vectorized iota kernel. Ranges
+// longer than PARALLEL_FILL_THRESHOLD are split in one block per thread, so
+// the writes of big ranges are not limited by the bandwidth of a single core.
+void parallelFillInto(const Range &range, RangeType *dst);
+
+// Same as above but resizing dst to the size of range.
+void parallelFillInto(const Range &range, QVector<RangeType> &dst);
+
+// Reduces range in a single pass: the range is split in one contiguous block
+// per thread, every thread reduces its block with reduceBlock(const Range &),
+// and then the partial results are combined once with combine(a, b).
+// It works with ranges of any type, reduceBlock receives a block of the same
+// type as range.
+template <typename T,
+          typename BlockFunction,
+          typename CombineFunction,
+          typename R>
+T parallelBlockReduce(const BasicRange<R> &range,
+                      BlockFunction reduceBlock,
+                      CombineFunction combine)
+{
+    struct Block
+    {
+        BasicRange<R> range;
+        T result;
+    };
+
+    QVector<BasicRange<R>> ranges =
+            range.split(QThreadPool::globalInstance()->maxThreadCount());
+    QVector<Block> blocks(ranges.size());
+
+    for (int i = 0; i < ranges.size(); i++)
+        blocks[i].range = ranges[i];
+
+    auto runBlock = [&reduceBlock] (Block &block) {
+        TRACE_SCOPE("parallelBlockReduce", block.range.size());
+        block.result = reduceBlock(block.range);
+    };
+
+    if (blocks.size() < 2)
+        runBlock(blocks[0]);
+    else
+        QtConcurrent::blockingMap(blocks, runBlock);
+
+    T result = blocks[0].result;
+
+    for (int i = 1; i < blocks.size(); i++)
+        result = combine(result, blocks[i].result);
+
+    return result;
+}
+
+// Same as parallelBlockReduce(), but every thread folds its block into a
+// private accumulator with combine(accumulator, map(index)). init must be the
+// identity of combine, since every block starts from it.
+template <typename T,
+          typename MapFunction,
+          typename CombineFunction,
+          typename R>
+T parallelReduce(const BasicRange<R> &range,
+                 const T &init,
+                 MapFunction map,
+                 CombineFunction combine)
+{
+    return parallelBlockReduce<T>(range,
+                                  [&init, &map, &combine] (const BasicRange<R> &block) {
+        T accumulator = init;
+        R start = block.start();
+        R step = block.step();
+        qint64 size = block.size();
+
+        for (qint64 i = 0; i < size; i++)
+            accumulator = combine(accumulator,
+                                  map(RangeTraits<R>::at(start, step, i)));
+
+        return accumulator;
+    }, combine);
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,322 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <type_traits>
+#include <utility>
+
+#include "parallel.h"
+
+// Stages of a pipeline. Every stage receives a value from the range, passes
+// it through the previous stages and then pushes zero or one values to
+// sink(const value_type &). Stages are plain templates over the functors, so
+// the whole chain inlines into the loop over the block.
+
+template <typename T>
+struct RangeSourceStage
+{
+    typedef T value_type;
+    static constexpr bool filtered = false;
+
+    template <typename Sink>
+    void operator ()(T value, Sink &sink) const
+    {
+        sink(value);
+    }
+};
+
+template <typename Stage, typename Function>
+struct RangeMapStage
+{
+    typedef typename Stage::value_type input_type;
+    typedef typename std::decay<decltype(std::declval<const Function &>()(std::declval<const input_type &>()))>::type value_type;
+    static constexpr bool filtered = Stage::filtered;
+
+    Stage stage;
+    Function function;
+
+    template <typename Input, typename Sink>
+    void operator ()(Input value, Sink &sink) const
+    {
+        auto mapSink = [this, &sink] (const input_type &input) {
+            sink(this->function(input));
+        };
+
+        this->stage(value, mapSink);
+    }
+};
+
+template <typename Stage, typename Predicate>
+struct RangeFilterStage
+{
+    typedef typename Stage::value_type value_type;
+    static constexpr bool filtered = true;
+
+    Stage stage;
+    Predicate predicate;
+
+    template <typename Input, typename Sink>
+    void operator ()(Input value, Sink &sink) const
+    {
+        auto filterSink = [this, &sink] (const value_type &input) {
+            if (this->predicate(input))
+                sink(input);
+        };
+
+        this->stage(value, filterSink);
+    }
+};
+
+// A lazy chain of map() and filter() stages over a range. Nothing is
+// evaluated until reduce() or collect() is called, then the range is split in
+// one block per thread and every thread runs all the stages fused in a single
+// loop over its block, without intermediate buffers.
+// The functors are called concurrently, so they must be callable as const and
+// must not modify shared state.
+template <typename T, typename Stage>
+class RangePipeline
+{
+    public:
+        typedef typename BasicRange<T>::size_type size_type;
+        typedef typename Stage::value_type value_type;
+
+        RangePipeline(const BasicRange<T> &range, const Stage &stage);
+        size_type collect(value_type *dst) const;
+        size_type collect(QVector<value_type> &dst) const;
+        template <typename Predicate>
+        RangePipeline<T, RangeFilterStage<Stage, Predicate>>
+        filter(Predicate predicate) const;
+        template <typename Function>
+        RangePipeline<T, RangeMapStage<Stage, Function>>
+        map(Function function) const;
+        const BasicRange<T> &range() const;
+        template <typename R, typename CombineFunction>
+        R reduce(const R &init, CombineFunction combine) const;
+
+    private:
+        struct Block
+        {
+            BasicRange<T> range;
+            size_type offset;
+            size_type count;
+        };
+
+        BasicRange<T> m_range;
+        Stage m_stage;
+
+        QVector<Block> countBlocks(size_type *count) const;
+        template <typename Sink>
+        void runBlock(const BasicRange<T> &block, Sink &sink) const;
+        template <typename Function>
+        static void runBlocks(QVector<Block> &blocks, Function function);
+        void writeBlocks(QVector<Block> &blocks, value_type *dst) const;
+};
+
+template <typename T, typename Stage>
+RangePipeline<T, Stage>::RangePipeline(const BasicRange<T> &range,
+                                       const Stage &stage):
+    m_range(range),
+    m_stage(stage)
+{
+}
+
+// Writes the values that come out of the pipeline in dst, in the order of
+// the range, and returns the number of values written. dst must have room for
+// range().size() values.
+// Filtered pipelines run twice, once to count the values of every block and
+// once to write them in their place.
+template <typename T, typename Stage>
+typename RangePipeline<T, Stage>::size_type
+RangePipeline<T, Stage>::collect(value_type *dst) const
+{
+    size_type count = 0;
+    QVector<Block> blocks = this->countBlocks(&count);
+    this->writeBlocks(blocks, dst);
+
+    return count;
+}
+
+// Same as above but resizing dst to the number of values.
+template <typename T, typename Stage>
+typename RangePipeline<T, Stage>::size_type
+RangePipeline<T, Stage>::collect(QVector<value_type> &dst) const
+{
+    size_type count = 0;
+    QVector<Block> blocks = this->countBlocks(&count);
+    dst.resize(static_cast<int>(count));
+    this->writeBlocks(blocks, dst.data());
+
+    return count;
+}
+
+template <typename T, typename Stage>
+template <typename Predicate>
+RangePipeline<T, RangeFilterStage<Stage, Predicate>>
+RangePipeline<T, Stage>::filter(Predicate predicate) const
+{
+    return RangePipeline<T, RangeFilterStage<Stage, Predicate>>(this->m_range,
+                                                                {this->m_stage,
+                                                                 predicate});
+}
+
+template <typename T, typename Stage>
+template <typename Function>
+RangePipeline<T, RangeMapStage<Stage, Function>>
+RangePipeline<T, Stage>::map(Function function) const
+{
+    return RangePipeline<T, RangeMapStage<Stage, Function>>(this->m_range,
+                                                             {this->m_stage,
+                                                              function});
+}
+
+template <typename T, typename Stage>
+const BasicRange<T> &RangePipeline<T, Stage>::range() const
+{
+    return this->m_range;
+}
+
+// Folds the values that come out of the pipeline with
+// combine(accumulator, value), and then combines the partial results of the
+// blocks with combine(a, b). init must be the identity of combine, since
+// every block starts from it.
+template <typename T, typename Stage>
+template <typename R, typename CombineFunction>
+R RangePipeline<T, Stage>::reduce(const R &init, CombineFunction combine) const
+{
+    return parallelBlockReduce<R>(this->m_range,
+                                  [this, &init, &combine] (const BasicRange<T> &block) {
+        R accumulator = init;
+
+        auto sink = [&accumulator, &combine] (const value_type &value) {
+            accumulator = combine(accumulator, value);
+        };
+
+        this->runBlock(block, sink);
+
+        return accumulator;
+    }, combine);
+}
+
+template <typename T, typename Stage>
+QVector<typename RangePipeline<T, Stage>::Block>
+RangePipeline<T, Stage>::countBlocks(size_type *count) const
+{
+    QVector<BasicRange<T>> ranges =
+            this->m_range.split(QThreadPool::globalInstance()->maxThreadCount());
+    QVector<Block> blocks(ranges.size());
+
+    for (int i = 0; i < ranges.size(); i++) {
+        blocks[i].range = ranges[i];
+        blocks[i].count = ranges[i].size();
+    }
+
+    // Without filters every value of the range gives exactly one value.
+    if (Stage::filtered)
+        runBlocks(blocks, [this] (Block &block) {
+            size_type count = 0;
+
+            auto sink = [&count] (const value_type &) {
+                count++;
+            };
+
+            this->runBlock(block.range, sink);
+            block.count = count;
+        });
+
+    *count = 0;
+
+    for (Block &block: blocks) {
+        block.offset = *count;
+        *count += block.count;
+    }
+
+    return blocks;
+}
+
+template <typename T, typename Stage>
+template <typename Sink>
+void RangePipeline<T, Stage>::runBlock(const BasicRange<T> &block,
+                                       Sink &sink) const
+{
+    T start = block.start();
+    T step = block.step();
+    size_type size = block.size();
+
+    for (size_type i = 0; i < size; i++)
+        this->m_stage(RangeTraits<T>::at(start, step, i), sink);
+}
+
+template <typename T, typename Stage>
+template <typename Function>
+void RangePipeline<T, Stage>::runBlocks(QVector<Block> &blocks,
+                                        Function function)
+{
+    auto runBlock = [&function] (Block &block) {
+        TRACE_SCOPE("RangePipeline", block.range.size());
+        function(block);
+    };
+
+    if (blocks.size() < 2) {
+        for (Block &block: blocks)
+            runBlock(block);
+
+        return;
+    }
+
+    QtConcurrent::blockingMap(blocks, runBlock);
+}
+
+template <typename T, typename Stage>
+void RangePipeline<T, Stage>::writeBlocks(QVector<Block> &blocks,
+                                          value_type *dst) const
+{
+    runBlocks(blocks, [this, dst] (Block &block) {
+        value_type *out = dst + block.offset;
+
+        auto sink = [&out] (const value_type &value) {
+            *out++ = value;
+        };
+
+        this->runBlock(block.range, sink);
+    });
+}
+
+// The members of BasicRange that start a pipeline, defined here so range.h
+// doesn't need the pipeline stages.
+template <typename T>
+template <typename Predicate>
+RangePipeline<T, RangeFilterStage<RangeSourceStage<T>, Predicate>>
+BasicRange<T>::filter(Predicate predicate) const
+{
+    return RangePipeline<T, RangeSourceStage<T>>(*this, {}).filter(predicate);
+}
+
+template <typename T>
+template <typename Function>
+RangePipeline<T, RangeMapStage<RangeSourceStage<T>, Function>>
+BasicRange<T>::map(Function function) const
+{
+    return RangePipeline<T, RangeSourceStage<T>>(*this, {}).map(function);
+}
+
+#endif // PIPELINE_H
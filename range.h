@@ -22,146 +22,1626 @@
 #ifndef QBRANGE_H
 #define QBRANGE_H
 
+#include <limits>
+#include <QtAlgorithms>
 #include <QtDebug>
 
-typedef int RangeType;
-class RangePrivate;
+// Modular arithmetic used to intersect ranges.
+class RangeMath
+{
+    public:
+        static constexpr quint64 gcd(quint64 a, quint64 b)
+        {
+            while (b) {
+                quint64 r = a % b;
+                a = b;
+                b = r;
+            }
+
+            return a;
+        }
+
+        // a * b mod m, without overflowing.
+        static constexpr quint64 mulMod(quint64 a, quint64 b, quint64 m)
+        {
+            quint64 result = 0;
+            a %= m;
+
+            for (; b; b >>= 1) {
+                if (b & 0x1)
+                    result = addMod(result, a, m);
+
+                a = addMod(a, a, m);
+            }
+
+            return result;
+        }
+
+        // The inverse of a modulo m, a and m must be coprime.
+        static constexpr quint64 inverse(quint64 a, quint64 m)
+        {
+            qint64 t = 0;
+            qint64 newT = 1;
+            quint64 r = m;
+            quint64 newR = a % m;
+
+            while (newR) {
+                quint64 q = r / newR;
+                qint64 nextT = t - qint64(q) * newT;
+                t = newT;
+                newT = nextT;
+                quint64 nextR = r - q * newR;
+                r = newR;
+                newR = nextR;
+            }
+
+            return t < 0? quint64(t + qint64(m)): quint64(t);
+        }
+
+    private:
+        static constexpr quint64 addMod(quint64 a, quint64 b, quint64 m)
+        {
+            return a >= m - b? a - (m - b): a + b;
+        }
+};
+
+// Exact division by a constant without dividing. The divisor is split as
+// odd * 2^shift and the odd part is inverted modulo 2^bits, then for every
+// multiple x of the divisor x / divisor == rotr(x * inverse, shift), while
+// every other x gives a quotient bigger than max(U) / divisor. So a single
+// comparison of the quotient tells if x is a multiple and below a bound.
+// Powers of two have inverse 1 and reduce to a rotation.
+template <typename U>
+class RangeDivisor
+{
+    public:
+        constexpr RangeDivisor(U divisor=1):
+            m_inverse(0),
+            m_shift(0)
+        {
+            if (!divisor)
+                return;
+
+            this->m_shift = int(qCountTrailingZeroBits(quint64(divisor)));
+            U odd = U(divisor >> this->m_shift);
+
+            // Newton's iteration, odd is its own inverse modulo 8 and every
+            // step doubles the number of correct bits.
+            U inverse = odd;
+
+            for (int bits = 3; odd != 1 && bits < BITS; bits *= 2)
+                inverse = U(quint64(inverse) * (2 - quint64(odd) * inverse));
+
+            this->m_inverse = inverse;
+        }
+
+        constexpr U inverse() const
+        {
+            return this->m_inverse;
+        }
+
+        constexpr int shift() const
+        {
+            return this->m_shift;
+        }
+
+        constexpr U quotient(U x) const
+        {
+            U q = U(quint64(x) * this->m_inverse);
+
+            return this->m_shift?
+                        U(quint64(q) >> this->m_shift
+                          | quint64(q) << (BITS - this->m_shift)):
+                        q;
+        }
+
+    private:
+        static constexpr int BITS = 8 * int(sizeof(U));
+
+        U m_inverse;
+        int m_shift;
+};
+
+// Arithmetic of the ranges, integer ranges compute the offsets in the unsigned
+// type so they can't overflow, floating point ranges compute every element
+// from start instead of accumulating steps, so they don't drift.
+template <typename T, bool isFloat=std::is_floating_point<T>::value>
+class RangeTraits
+{
+    public:
+        typedef qint64 SizeType;
+        typedef typename std::make_unsigned<T>::type UnsignedType;
+
+        static constexpr T at(T start, T step, SizeType i)
+        {
+            return T(UnsignedType(start)
+                     + UnsignedType(i) * UnsignedType(step));
+        }
+
+        static constexpr SizeType size(T start, T stop, T step)
+        {
+            UnsignedType size = unsignedSize(start, stop, step);
+
+            // Clamp sizes that don't fit in SizeType.
+            if (size > UnsignedType(std::numeric_limits<SizeType>::max()))
+                return std::numeric_limits<SizeType>::max();
+
+            return SizeType(size);
+        }
+
+        // Only 64 bits ranges can have more elements than SizeType counts.
+        static constexpr bool sizeFits(T start, T stop, T step)
+        {
+            return unsignedSize(start, stop, step)
+                   <= UnsignedType(std::numeric_limits<SizeType>::max());
+        }
+
+        // step * k, for k smaller than the size of a range with that step,
+        // whose product can't wrap around the unsigned type.
+        static constexpr T multiplyStep(T step, SizeType k)
+        {
+            UnsignedType product = absolute(step) * UnsignedType(k);
+            Q_ASSERT_X(product <= (isNegative(step)?
+                                       absolute(std::numeric_limits<T>::min()):
+                                       UnsignedType(std::numeric_limits<T>::max())),
+                       "BasicRange::stride",
+                       "the step doesn't fit in the type of the range");
+
+            return isNegative(step)?
+                        T(UnsignedType(0) - product):
+                        T(product);
+        }
+
+        // The value a step past value, or the end of T in the direction of
+        // step if it would wrap around.
+        static constexpr T next(T value, T step)
+        {
+            if (isNegative(step))
+                return UnsignedType(value)
+                       - UnsignedType(std::numeric_limits<T>::min())
+                       < absolute(step)?
+                            std::numeric_limits<T>::min():
+                            T(UnsignedType(value) - absolute(step));
+
+            return UnsignedType(std::numeric_limits<T>::max())
+                   - UnsignedType(value)
+                   < UnsignedType(step)?
+                        std::numeric_limits<T>::max():
+                        T(UnsignedType(value) + UnsignedType(step));
+        }
+
+        // A value is in the range if its distance to start is a multiple of
+        // step and is shorter than the distance to stop, so unlike indexOf()
+        // it doesn't need the size of the range.
+        static constexpr bool contains(T start, T stop, T step, T value)
+        {
+            if (step == T(0))
+                return false;
+
+            if (isNegative(step)? start <= stop: stop <= start)
+                return false;
+
+            UnsignedType span = isNegative(step)?
+                                    UnsignedType(start) - UnsignedType(stop):
+                                    UnsignedType(stop) - UnsignedType(start);
+            UnsignedType distance = isNegative(step)?
+                                        UnsignedType(start) - UnsignedType(value):
+                                        UnsignedType(value) - UnsignedType(start);
+            UnsignedType ustep = absolute(step);
+
+            if (distance >= span)
+                return false;
+
+            return !(ustep & (ustep - 1))?
+                        !(distance & (ustep - 1)):
+                        !(distance % ustep);
+        }
+
+        // Returns the index of value in the range, or -1 if not found.
+        // Values before start wrap around to distances that are either not
+        // multiples of step or give indexes past size, so they need no
+        // special case. Steps that are powers of two need no division, other
+        // steps are cheaper to divide once than to invert for a single value.
+        static constexpr SizeType indexOf(T start, T step, SizeType size, T value)
+        {
+            if (step == T(0))
+                return -1;
+
+            UnsignedType ustep = absolute(step);
+
+            if (!(ustep & (ustep - 1)))
+                return indexOf(start,
+                               isNegative(step),
+                               RangeDivisor<UnsignedType>(ustep),
+                               size,
+                               value);
+
+            UnsignedType distance = isNegative(step)?
+                                        UnsignedType(start) - UnsignedType(value):
+                                        UnsignedType(value) - UnsignedType(start);
+
+            if (distance % ustep)
+                return -1;
+
+            UnsignedType index = distance / ustep;
+
+            return index < UnsignedType(size)? SizeType(index): -1;
+        }
+
+        static constexpr SizeType indexOf(T start,
+                                          bool descending,
+                                          const RangeDivisor<UnsignedType> &divisor,
+                                          SizeType size,
+                                          T value)
+        {
+            UnsignedType distance = descending?
+                                        UnsignedType(start) - UnsignedType(value):
+                                        UnsignedType(value) - UnsignedType(start);
+            UnsignedType index = divisor.quotient(distance);
+
+            return index < UnsignedType(size)? SizeType(index): -1;
+        }
+
+        static void containsMany(T start,
+                                 T step,
+                                 SizeType size,
+                                 const T *values,
+                                 SizeType n,
+                                 bool *out)
+        {
+            // Compute the divisor once, the loop is then branchless.
+            bool descending = isNegative(step);
+            RangeDivisor<UnsignedType> divisor(absolute(step));
+
+            for (SizeType i = 0; i < n; i++)
+                out[i] = indexOf(start, descending, divisor, size, values[i]) >= 0;
+        }
+
+    private:
+        static constexpr bool isNegative(T value)
+        {
+            return std::is_signed<T>::value && value < T(0);
+        }
+
+        static constexpr UnsignedType unsignedSize(T start, T stop, T step)
+        {
+            if (step == T(0))
+                return 0;
+
+            if (isNegative(step)? start <= stop: stop <= start)
+                return 0;
+
+            UnsignedType distance = isNegative(step)?
+                                        UnsignedType(start) - UnsignedType(stop):
+                                        UnsignedType(stop) - UnsignedType(start);
+            UnsignedType ustep = absolute(step);
+
+            return distance / ustep + (distance % ustep? 1: 0);
+        }
+
+        static constexpr UnsignedType absolute(T value)
+        {
+            return isNegative(value)?
+                        UnsignedType(0) - UnsignedType(value):
+                        UnsignedType(value);
+        }
+};
+
+template <typename T>
+class RangeTraits<T, true>
+{
+    public:
+        typedef qint64 SizeType;
+
+        static constexpr T at(T start, T step, SizeType i)
+        {
+            return start + T(i) * step;
+        }
+
+        static constexpr SizeType size(T start, T stop, T step)
+        {
+            if (step == T(0)
+                || (step > T(0) && stop <= start)
+                || (step < T(0) && start <= stop))
+                return 0;
+
+            T size = (stop - start) / step;
+
+            if (size >= T(std::numeric_limits<SizeType>::max()))
+                return std::numeric_limits<SizeType>::max();
+
+            // The division is truncated and may also be rounded to either
+            // side, fix it so the last element is the last one that at()
+            // gives before stop.
+            SizeType n = SizeType(size);
+
+            while (n > 0 && !before(at(start, step, n - 1), stop, step))
+                n--;
+
+            while (before(at(start, step, n), stop, step))
+                n++;
+
+            return n;
+        }
+
+        static constexpr bool sizeFits(T start, T stop, T step)
+        {
+            return step == T(0)
+                   || T((stop - start) / step)
+                      < T(std::numeric_limits<SizeType>::max());
+        }
 
-// This class works as it were a list of monotonically increasing numbers.
+        static constexpr T multiplyStep(T step, SizeType k)
+        {
+            return step * T(k);
+        }
+
+        static constexpr T next(T value, T step)
+        {
+            return value + step;
+        }
+
+        static constexpr SizeType indexOf(T start, T step, SizeType size, T value)
+        {
+            if (step == T(0))
+                return -1;
+
+            T index = (value - start) / step;
+
+            if (index <= T(-0.5) || index >= T(size) - T(0.5))
+                return -1;
+
+            SizeType i = SizeType(index + T(0.5));
+
+            return at(start, step, i) == value? i: -1;
+        }
+
+        static constexpr bool contains(T start, T stop, T step, T value)
+        {
+            return indexOf(start, step, size(start, stop, step), value) >= 0;
+        }
+
+        static void containsMany(T start,
+                                 T step,
+                                 SizeType size,
+                                 const T *values,
+                                 SizeType n,
+                                 bool *out)
+        {
+            for (SizeType i = 0; i < n; i++)
+                out[i] = indexOf(start, step, size, values[i]) >= 0;
+        }
+
+    private:
+        static constexpr bool before(T value, T stop, T step)
+        {
+            return step > T(0)? value < stop: value > stop;
+        }
+};
+
+// Lazy pipelines over a range, defined in pipeline.h. map() and filter()
+// start a pipeline, and are only defined where pipeline.h is included.
+template <typename T, typename Stage>
+class RangePipeline;
+template <typename T>
+struct RangeSourceStage;
+template <typename Stage, typename Function>
+struct RangeMapStage;
+template <typename Stage, typename Predicate>
+struct RangeFilterStage;
+
+// This class works as it were a list of evenly spaced numbers.
 // It doesn't stores real data, but only values of start, stop and stepping.
-class Range
+template <typename T>
+class BasicRange
 {
     public:
+        typedef typename RangeTraits<T>::SizeType size_type;
+
         class iterator
         {
             public:
                 typedef std::random_access_iterator_tag iterator_category;
-                typedef int difference_type;
-                typedef RangeType value_type;
-                typedef RangeType *pointer;
-                typedef RangeType &reference;
-
-                iterator();
-                iterator(const Range &range, int pos);
-                iterator(const iterator &other);
-                iterator(const iterator &other, int pos);
-                ~iterator();
-                RangeType start() const;
-                RangeType stop() const;
-                RangeType step() const;
-                int pos() const;
-                RangeType operator *() const;
-                RangeType operator [](difference_type i) const;
-                bool operator ==(const iterator &other) const;
-                bool operator !=(const iterator &other) const;
-                iterator &operator ++();
-                iterator operator ++(int);
-                iterator &operator --();
-                iterator operator --(int);
-                iterator &operator +=(difference_type i);
-                iterator &operator -=(difference_type i);
-                iterator operator +(difference_type i) const;
-                iterator operator -(difference_type i) const;
-                int operator -(const iterator &other) const;
+                typedef size_type difference_type;
+                typedef T value_type;
+                typedef T *pointer;
+                typedef T &reference;
+
+                constexpr iterator();
+                constexpr iterator(const BasicRange &range, difference_type pos);
+                constexpr iterator(T start,
+                                 T stop,
+                                 T step,
+                                 difference_type pos);
+                constexpr iterator(const iterator &other, difference_type pos);
+                constexpr T start() const;
+                constexpr T stop() const;
+                constexpr T step() const;
+                constexpr difference_type pos() const;
+                constexpr T operator *() const;
+                constexpr T operator [](difference_type i) const;
+                constexpr bool operator ==(const iterator &other) const;
+                constexpr bool operator !=(const iterator &other) const;
+                constexpr iterator &operator ++();
+                constexpr iterator operator ++(int);
+                constexpr iterator &operator --();
+                constexpr iterator operator --(int);
+                constexpr iterator &operator +=(difference_type i);
+                constexpr iterator &operator -=(difference_type i);
+                constexpr iterator operator +(difference_type i) const;
+                constexpr iterator operator -(difference_type i) const;
+                constexpr difference_type operator -(const iterator &other) const;
 
             private:
-                RangePrivate *d;
+                T m_start;
+                T m_stop;
+                T m_step;
+                difference_type m_pos;
+
+            friend QDebug operator <<(QDebug debug, const iterator &rangeIterator)
+            {
+                debug.nospace() << "Range::iterator("
+                                << rangeIterator.m_start
+                                << ", "
+                                << rangeIterator.m_stop
+                                << ", "
+                                << rangeIterator.m_step
+                                << ")";
 
-            friend QDebug operator <<(QDebug debug, const Range::iterator &rangeIterator);
+                return debug.space();
+            }
         };
 
         class const_iterator
         {
             public:
                 typedef std::random_access_iterator_tag  iterator_category;
-                typedef int difference_type;
-                typedef RangeType value_type;
-                typedef const RangeType *pointer;
-                typedef const RangeType &reference;
-
-                const_iterator();
-                const_iterator(const Range &range, int pos);
-                const_iterator(const const_iterator &other);
-                const_iterator(const const_iterator &other, int pos);
-                const_iterator(const iterator &other);
-                ~const_iterator();
-                RangeType operator *() const;
-                RangeType operator [](difference_type i) const;
-                bool operator ==(const const_iterator &other) const;
-                bool operator !=(const const_iterator &other) const;
-                const_iterator &operator ++();
-                const_iterator operator ++(int);
-                const_iterator &operator --();
-                const_iterator operator --(int);
-                const_iterator &operator +=(difference_type i);
-                const_iterator &operator -=(difference_type i);
-                const_iterator operator +(difference_type i) const;
-                const_iterator operator -(difference_type i) const;
-                int operator -(const const_iterator &other) const;
+                typedef size_type difference_type;
+                typedef T value_type;
+                typedef const T *pointer;
+                typedef const T &reference;
+
+                constexpr const_iterator();
+                constexpr const_iterator(const BasicRange &range, difference_type pos);
+                constexpr const_iterator(T start,
+                                       T stop,
+                                       T step,
+                                       difference_type pos);
+                constexpr const_iterator(const const_iterator &other, difference_type pos);
+                constexpr const_iterator(const iterator &other);
+                constexpr T start() const;
+                constexpr T stop() const;
+                constexpr T step() const;
+                constexpr difference_type pos() const;
+                constexpr T operator *() const;
+                constexpr T operator [](difference_type i) const;
+                constexpr bool operator ==(const const_iterator &other) const;
+                constexpr bool operator !=(const const_iterator &other) const;
+                constexpr const_iterator &operator ++();
+                constexpr const_iterator operator ++(int);
+                constexpr const_iterator &operator --();
+                constexpr const_iterator operator --(int);
+                constexpr const_iterator &operator +=(difference_type i);
+                constexpr const_iterator &operator -=(difference_type i);
+                constexpr const_iterator operator +(difference_type i) const;
+                constexpr const_iterator operator -(difference_type i) const;
+                constexpr difference_type operator -(const const_iterator &other) const;
 
             private:
-                RangePrivate *d;
+                T m_start;
+                T m_stop;
+                T m_step;
+                difference_type m_pos;
+
+            friend QDebug operator <<(QDebug debug, const const_iterator &rangeIterator)
+            {
+                debug.nospace() << "Range::const_iterator("
+                                << rangeIterator.m_start
+                                << ", "
+                                << rangeIterator.m_stop
+                                << ", "
+                                << rangeIterator.m_step
+                                << ")";
 
-            friend QDebug operator <<(QDebug debug, const Range::const_iterator &rangeIterator);
+                return debug.space();
+            }
         };
 
-        Range();
-        Range(RangeType stop);
-        Range(RangeType start, RangeType stop, RangeType step=1);
-        ~Range();
-        void append(RangeType value);
-        RangeType at(int i) const;
-        RangeType back() const;
-        iterator begin();
-        const_iterator begin() const;
-        const_iterator cbegin() const;
-        const_iterator cend() const;
-        void clear();
-        bool contains(RangeType value) const;
-        int count(RangeType value) const;
-        int count();
-        bool empty();
-        iterator end();
-        const_iterator end() const;
-        RangeType first() const;
-        bool isEmpty();
-        RangeType last() const;
-        int length() const;
-        void prepend(RangeType value);
-        void push_back(RangeType value);
-        void push_front(RangeType value);
-        void setStart(RangeType start);
-        void setStop(RangeType stop);
-        void setStep(RangeType step);
-        int size() const;
-        RangeType start() const;
-        RangeType &start();
-        RangeType stop() const;
-        RangeType &stop();
-        RangeType step() const;
-        RangeType &step();
-        QList<RangeType> toList() const;
-        QVector<RangeType> toVector() const;
-        RangeType value(int i) const;
-        RangeType value(int i, RangeType defaultValue) const;
-        bool operator !=(const Range &other) const;
-        Range &operator <<(RangeType value);
-        Range &operator =(const Range &other);
-        bool operator ==(const Range &other) const;
-        RangeType operator [](int i) const;
+        constexpr BasicRange();
+        constexpr BasicRange(T stop);
+        constexpr BasicRange(T start, T stop, T step=1);
+        constexpr void append(T value);
+        constexpr T at(size_type i) const;
+        constexpr T back() const;
+        constexpr iterator begin();
+        constexpr const_iterator begin() const;
+        constexpr const_iterator cbegin() const;
+        constexpr const_iterator cend() const;
+        QVector<BasicRange> chunks(size_type grain) const;
+        constexpr void clear();
+        constexpr bool contains(T value) const;
+        void containsMany(const T *values, size_type n, bool *out) const;
+        constexpr size_type count(T value) const;
+        constexpr size_type count() const;
+        int difference(const BasicRange &other,
+                       BasicRange *ranges,
+                       int maxRanges) const;
+        QVector<BasicRange> difference(const BasicRange &other) const;
+        constexpr bool empty() const;
+        constexpr iterator end();
+        constexpr const_iterator end() const;
+        void fillInto(T *dst) const;
+        void fillInto(QVector<T> &dst) const;
+        template <typename Predicate>
+        RangePipeline<T, RangeFilterStage<RangeSourceStage<T>, Predicate>>
+        filter(Predicate predicate) const;
+        constexpr T first() const;
+        constexpr BasicRange intersect(const BasicRange &other) const;
+        constexpr size_type indexOf(T value) const;
+        constexpr bool isEmpty() const;
+        constexpr bool isValid() const;
+        constexpr T last() const;
+        constexpr size_type length() const;
+        template <typename Function>
+        RangePipeline<T, RangeMapStage<RangeSourceStage<T>, Function>>
+        map(Function function) const;
+        constexpr void prepend(T value);
+        constexpr void push_back(T value);
+        constexpr void push_front(T value);
+        constexpr BasicRange reversed() const;
+        constexpr void setStart(T start);
+        constexpr void setStop(T stop);
+        constexpr void setStep(T step);
+        constexpr size_type size() const;
+        constexpr BasicRange slice(size_type i, size_type j) const;
+        QVector<BasicRange> split(int n) const;
+        constexpr T start() const;
+        constexpr T &start();
+        constexpr T stop() const;
+        constexpr T &stop();
+        constexpr T step() const;
+        constexpr T &step();
+        constexpr BasicRange stride(size_type k) const;
+        QList<T> toList() const;
+        QVector<T> toVector() const;
+        constexpr T value(size_type i) const;
+        constexpr T value(size_type i, T defaultValue) const;
+        constexpr bool operator !=(const BasicRange &other) const;
+        constexpr BasicRange &operator <<(T value);
+        constexpr bool operator ==(const BasicRange &other) const;
+        constexpr T operator [](size_type i) const;
 
     private:
-        RangePrivate *d;
+        T m_start;
+        T m_stop;
+        T m_step;
 
-    friend QDebug operator <<(QDebug debug, const Range &range);
-    friend QDataStream &operator >>(QDataStream &istream, Range &range); \
-    friend QDataStream &operator <<(QDataStream &ostream, const Range &range);
+        constexpr BasicRange ascending() const;
+        constexpr BasicRange reversedRange() const;
+        constexpr bool intersectIndexes(const BasicRange &other,
+                                        size_type *first,
+                                        size_type *count,
+                                        size_type *step) const;
 };
 
-QDebug operator <<(QDebug debug, const Range &range);
-QDebug operator <<(QDebug debug, const Range::iterator &rangeIterator);
-QDebug operator <<(QDebug debug, const Range::const_iterator &rangeIterator);
-QDataStream &operator >>(QDataStream &istream, Range &range);
-QDataStream &operator <<(QDataStream &ostream, const Range &range);
+typedef int RangeType;
+typedef BasicRange<RangeType> Range;
+
+template <typename T>
+constexpr BasicRange<T>::iterator::iterator():
+    m_start(0),
+    m_stop(0),
+    m_step(1),
+    m_pos(0)
+{
+}
+
+template <typename T>
+constexpr BasicRange<T>::iterator::iterator(const BasicRange<T> &range,
+                                         typename BasicRange<T>::iterator::difference_type pos):
+    m_start(range.start()),
+    m_stop(range.stop()),
+    m_step(range.step()),
+    m_pos(pos)
+{
+}
+
+template <typename T>
+constexpr BasicRange<T>::iterator::iterator(T start,
+                                            T stop,
+                                            T step,
+                                            typename BasicRange<T>::iterator::difference_type pos):
+    m_start(start),
+    m_stop(stop),
+    m_step(step),
+    m_pos(pos)
+{
+}
+
+template <typename T>
+constexpr BasicRange<T>::iterator::iterator(const typename BasicRange<T>::iterator &other,
+                                            typename BasicRange<T>::iterator::difference_type pos):
+    m_start(other.m_start),
+    m_stop(other.m_stop),
+    m_step(other.m_step),
+    m_pos(pos)
+{
+}
+
+template <typename T>
+constexpr T BasicRange<T>::iterator::start() const
+{
+    return this->m_start;
+}
+
+template <typename T>
+constexpr T BasicRange<T>::iterator::stop() const
+{
+    return this->m_stop;
+}
+
+template <typename T>
+constexpr T BasicRange<T>::iterator::step() const
+{
+    return this->m_step;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::iterator::difference_type BasicRange<T>::iterator::pos() const
+{
+    return this->m_pos;
+}
+
+template <typename T>
+constexpr T BasicRange<T>::iterator::operator *() const
+{
+    return RangeTraits<T>::at(this->m_start, this->m_step, this->m_pos);
+}
+
+template <typename T>
+constexpr T BasicRange<T>::iterator::operator [](typename BasicRange<T>::iterator::difference_type i) const
+{
+    return RangeTraits<T>::at(this->m_start, this->m_step, this->m_pos + i);
+}
+
+template <typename T>
+constexpr bool BasicRange<T>::iterator::operator ==(const typename BasicRange<T>::iterator &other) const
+{
+    return this->m_start == other.m_start
+           && this->m_stop == other.m_stop
+           && this->m_step == other.m_step
+           && this->m_pos == other.m_pos;
+}
+
+template <typename T>
+constexpr bool BasicRange<T>::iterator::operator !=(const typename BasicRange<T>::iterator &other) const
+{
+    return !(*this == other);
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::iterator &BasicRange<T>::iterator::operator ++()
+{
+    this->m_pos++;
+
+    return *this;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::iterator BasicRange<T>::iterator::operator ++(int)
+{
+    iterator it(*this);
+    this->m_pos++;
+
+    return it;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::iterator &BasicRange<T>::iterator::operator --()
+{
+    this->m_pos--;
+
+    return *this;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::iterator BasicRange<T>::iterator::operator --(int)
+{
+    iterator it(*this);
+    this->m_pos--;
+
+    return it;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::iterator &BasicRange<T>::iterator::operator +=(typename BasicRange<T>::iterator::difference_type i)
+{
+    this->m_pos += i;
+
+    return *this;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::iterator &BasicRange<T>::iterator::operator -=(typename BasicRange<T>::iterator::difference_type i)
+{
+    this->m_pos -= i;
+
+    return *this;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::iterator BasicRange<T>::iterator::operator +(typename BasicRange<T>::iterator::difference_type i) const
+{
+    return iterator(*this, this->m_pos + i);
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::iterator BasicRange<T>::iterator::operator -(typename BasicRange<T>::iterator::difference_type i) const
+{
+    return iterator(*this, this->m_pos - i);
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::iterator::difference_type BasicRange<T>::iterator::operator -(const typename BasicRange<T>::iterator &other) const
+{
+    return this->m_pos - other.m_pos;
+}
+
+template <typename T>
+constexpr BasicRange<T>::const_iterator::const_iterator():
+    m_start(0),
+    m_stop(0),
+    m_step(1),
+    m_pos(0)
+{
+}
+
+template <typename T>
+constexpr BasicRange<T>::const_iterator::const_iterator(const BasicRange<T> &range,
+                                                     typename BasicRange<T>::const_iterator::difference_type pos):
+    m_start(range.start()),
+    m_stop(range.stop()),
+    m_step(range.step()),
+    m_pos(pos)
+{
+}
+
+template <typename T>
+constexpr BasicRange<T>::const_iterator::const_iterator(T start,
+                                                        T stop,
+                                                        T step,
+                                                        typename BasicRange<T>::const_iterator::difference_type pos):
+    m_start(start),
+    m_stop(stop),
+    m_step(step),
+    m_pos(pos)
+{
+}
+
+template <typename T>
+constexpr BasicRange<T>::const_iterator::const_iterator(const typename BasicRange<T>::const_iterator &other,
+                                                        typename BasicRange<T>::const_iterator::difference_type pos):
+    m_start(other.m_start),
+    m_stop(other.m_stop),
+    m_step(other.m_step),
+    m_pos(pos)
+{
+}
+
+template <typename T>
+constexpr BasicRange<T>::const_iterator::const_iterator(const typename BasicRange<T>::iterator &other):
+    m_start(other.start()),
+    m_stop(other.stop()),
+    m_step(other.step()),
+    m_pos(other.pos())
+{
+}
+
+template <typename T>
+constexpr T BasicRange<T>::const_iterator::start() const
+{
+    return this->m_start;
+}
+
+template <typename T>
+constexpr T BasicRange<T>::const_iterator::stop() const
+{
+    return this->m_stop;
+}
+
+template <typename T>
+constexpr T BasicRange<T>::const_iterator::step() const
+{
+    return this->m_step;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator::difference_type BasicRange<T>::const_iterator::pos() const
+{
+    return this->m_pos;
+}
+
+template <typename T>
+constexpr T BasicRange<T>::const_iterator::operator *() const
+{
+    return RangeTraits<T>::at(this->m_start, this->m_step, this->m_pos);
+}
+
+template <typename T>
+constexpr T BasicRange<T>::const_iterator::operator [](typename BasicRange<T>::const_iterator::difference_type i) const
+{
+    return RangeTraits<T>::at(this->m_start, this->m_step, this->m_pos + i);
+}
+
+template <typename T>
+constexpr bool BasicRange<T>::const_iterator::operator ==(const typename BasicRange<T>::const_iterator &other) const
+{
+    return this->m_start == other.m_start
+           && this->m_stop == other.m_stop
+           && this->m_step == other.m_step
+           && this->m_pos == other.m_pos;
+}
+
+template <typename T>
+constexpr bool BasicRange<T>::const_iterator::operator !=(const typename BasicRange<T>::const_iterator &other) const
+{
+    return !(*this == other);
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator &BasicRange<T>::const_iterator::operator ++()
+{
+    this->m_pos++;
+
+    return *this;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator BasicRange<T>::const_iterator::operator ++(int)
+{
+    const_iterator it(*this);
+    this->m_pos++;
+
+    return it;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator &BasicRange<T>::const_iterator::operator --()
+{
+    this->m_pos--;
+
+    return *this;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator BasicRange<T>::const_iterator::operator --(int)
+{
+    const_iterator it(*this);
+    this->m_pos--;
+
+    return it;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator &BasicRange<T>::const_iterator::operator +=(typename BasicRange<T>::const_iterator::difference_type i)
+{
+    this->m_pos += i;
+
+    return *this;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator &BasicRange<T>::const_iterator::operator -=(typename BasicRange<T>::const_iterator::difference_type i)
+{
+    this->m_pos -= i;
+
+    return *this;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator BasicRange<T>::const_iterator::operator +(typename BasicRange<T>::const_iterator::difference_type i) const
+{
+    return const_iterator(*this, this->m_pos + i);
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator BasicRange<T>::const_iterator::operator -(typename BasicRange<T>::const_iterator::difference_type i) const
+{
+    return const_iterator(*this, this->m_pos - i);
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator::difference_type BasicRange<T>::const_iterator::operator -(const typename BasicRange<T>::const_iterator &other) const
+{
+    return this->m_pos - other.m_pos;
+}
+
+template <typename T>
+constexpr BasicRange<T>::BasicRange():
+    m_start(0),
+    m_stop(0),
+    m_step(1)
+{
+}
+
+template <typename T>
+constexpr BasicRange<T>::BasicRange(T stop):
+    m_start(0),
+    m_stop(stop),
+    m_step(1)
+{
+}
+
+template <typename T>
+constexpr BasicRange<T>::BasicRange(T start, T stop, T step):
+    m_start(start),
+    m_stop(stop),
+    m_step(step)
+{
+    Q_ASSERT_X(this->isValid(),
+               "BasicRange",
+               "the number of elements doesn't fit in size_type");
+}
+
+template <typename T>
+constexpr void BasicRange<T>::append(T value)
+{
+    if (this->m_stop == this->m_start) {
+        this->m_step = value;
+
+        this->m_stop = 2 * value;
+
+        return;
+    }
+
+    this->m_step = this->m_step * (value - this->m_start)
+                   / (this->m_stop - this->m_start);
+
+    this->m_stop = value + this->m_step;
+}
+
+template <typename T>
+constexpr T BasicRange<T>::at(typename BasicRange<T>::size_type i) const
+{
+    return RangeTraits<T>::at(this->m_start, this->m_step, i);
+}
+
+template <typename T>
+constexpr T BasicRange<T>::back() const
+{
+    return this->last();
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::iterator BasicRange<T>::begin()
+{
+    return iterator(*this, 0);
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator BasicRange<T>::begin() const
+{
+    return const_iterator(*this, 0);
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator BasicRange<T>::cbegin() const
+{
+    return const_iterator(*this, 0);
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator BasicRange<T>::cend() const
+{
+    return const_iterator(*this, this->size());
+}
+
+// Cut the range in consecutive sub-ranges of grain elements, the last one
+// may be shorter.
+template <typename T>
+QVector<BasicRange<T>> BasicRange<T>::chunks(typename BasicRange<T>::size_type grain) const
+{
+    size_type size = this->size();
+    grain = qMax<size_type>(grain, 1);
+    size_type chunkCount = (size + grain - 1) / grain;
+    Q_ASSERT_X(chunkCount <= std::numeric_limits<int>::max(),
+               "BasicRange::chunks",
+               "too many chunks, use a bigger grain");
+    int n = int(chunkCount);
+    QVector<BasicRange<T>> chunks(n);
+
+    for (int i = 0; i < n; i++) {
+        T start = this->at(size_type(i) * grain);
+        T stop = i < n - 1? this->at(size_type(i + 1) * grain): this->m_stop;
+        chunks[i] = BasicRange<T>(start, stop, this->m_step);
+    }
+
+    return chunks;
+}
+
+template <typename T>
+constexpr void BasicRange<T>::clear()
+{
+    this->m_start = 0;
+    this->m_stop = 0;
+    this->m_step = 1;
+}
+
+template <typename T>
+constexpr bool BasicRange<T>::contains(T value) const
+{
+    return RangeTraits<T>::contains(this->m_start,
+                                    this->m_stop,
+                                    this->m_step,
+                                    value);
+}
+
+// Writes in out[i] whether values[i] is in the range. Cheaper than calling
+// contains() for every value, since the step is inverted only once.
+template <typename T>
+inline void BasicRange<T>::containsMany(const T *values,
+                                        size_type n,
+                                        bool *out) const
+{
+    RangeTraits<T>::containsMany(this->m_start,
+                                 this->m_step,
+                                 this->size(),
+                                 values,
+                                 n,
+                                 out);
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::size_type BasicRange<T>::count(T value) const
+{
+    if (this->contains(value))
+        return 1;
+
+    return 0;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::size_type BasicRange<T>::count() const
+{
+    return this->size();
+}
+
+// Writes in ranges the elements of this range that are not in other, as up
+// to maxRanges ascending ranges, and returns the number of ranges needed to
+// describe the whole difference, which may be bigger than maxRanges.
+// Integer ranges only.
+template <typename T>
+int BasicRange<T>::difference(const BasicRange<T> &other,
+                              BasicRange<T> *ranges,
+                              int maxRanges) const
+{
+    BasicRange<T> range = this->ascending();
+    size_type size = range.size();
+    size_type first = 0;
+    size_type count = 0;
+    size_type step = 1;
+    int n = 0;
+
+    auto add = [ranges, maxRanges, &n] (const BasicRange<T> &piece) {
+        if (piece.isEmpty())
+            return;
+
+        if (n < maxRanges)
+            ranges[n] = piece;
+
+        n++;
+    };
+
+    if (!range.intersectIndexes(other, &first, &count, &step)) {
+        add(range);
+
+        return n;
+    }
+
+    size_type last = first + (count - 1) * step;
+    add(range.slice(0, first));
+
+    // The elements between the first and the last common ones can be
+    // described either as the step - 1 residue classes that are not common,
+    // or as the count - 1 gaps between the common elements, use the shortest.
+    if (step > 1 && count > 1) {
+        if (step - 1 <= count - 1)
+            for (size_type i = 1; i < step; i++)
+                add(range.slice(first + i, last).stride(step));
+        else
+            for (size_type i = 0; i < count - 1; i++)
+                add(range.slice(first + i * step + 1,
+                                first + (i + 1) * step));
+    }
+
+    add(range.slice(last + 1, size));
+
+    return n;
+}
+
+template <typename T>
+QVector<BasicRange<T>> BasicRange<T>::difference(const BasicRange<T> &other) const
+{
+    QVector<BasicRange<T>> ranges(this->difference(other, nullptr, 0));
+    this->difference(other, ranges.data(), ranges.size());
+
+    return ranges;
+}
+
+template <typename T>
+constexpr bool BasicRange<T>::empty() const
+{
+    return this->size() < 1;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::iterator BasicRange<T>::end()
+{
+    return iterator(*this, this->size());
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::const_iterator BasicRange<T>::end() const
+{
+    return const_iterator(*this, this->size());
+}
+
+// Writes the elements of the range in dst, which must have room for size()
+// elements. Every element is computed from its index, so the loop has no
+// dependencies between iterations and the compiler can vectorize it.
+template <typename T>
+inline void BasicRange<T>::fillInto(T *dst) const
+{
+    size_type size = this->size();
+    T start = this->m_start;
+    T step = this->m_step;
+
+    for (size_type i = 0; i < size; i++)
+        dst[i] = RangeTraits<T>::at(start, step, i);
+}
+
+// Same as above but resizing dst to size(), it won't reallocate if dst has
+// enough capacity.
+template <typename T>
+inline void BasicRange<T>::fillInto(QVector<T> &dst) const
+{
+    Q_ASSERT_X(this->size() <= std::numeric_limits<int>::max(),
+               "BasicRange::fillInto",
+               "the range doesn't fit in a QVector");
+    dst.resize(static_cast<int>(this->size()));
+    this->fillInto(dst.data());
+}
+
+template <typename T>
+constexpr T BasicRange<T>::first() const
+{
+    return this->m_start;
+}
+
+// The elements common to both ranges, as an ascending range.
+// Integer ranges only.
+template <typename T>
+constexpr BasicRange<T> BasicRange<T>::intersect(const BasicRange<T> &other) const
+{
+    BasicRange<T> range = this->ascending();
+    size_type first = 0;
+    size_type count = 0;
+    size_type step = 1;
+
+    if (!range.intersectIndexes(other, &first, &count, &step))
+        return BasicRange<T>(range.m_start, range.m_start, 1);
+
+    T start = range.at(first);
+    T last = range.at(first + (count - 1) * step);
+
+    return BasicRange<T>(start,
+                         RangeTraits<T>::next(last, T(1)),
+                         count > 1? T(range.m_step * step): T(1));
+}
+
+// Returns the index of value in the range, or -1 if it's not in the range.
+template <typename T>
+constexpr typename BasicRange<T>::size_type BasicRange<T>::indexOf(T value) const
+{
+    return RangeTraits<T>::indexOf(this->m_start,
+                                   this->m_step,
+                                   this->size(),
+                                   value);
+}
+
+// Returns false if the range has more elements than size_type can count,
+// only possible with 64 bits types. size() is clamped in that case, and the
+// elements past it can't be reached by index.
+template <typename T>
+constexpr bool BasicRange<T>::isValid() const
+{
+    return RangeTraits<T>::sizeFits(this->m_start,
+                                    this->m_stop,
+                                    this->m_step);
+}
+
+template <typename T>
+constexpr bool BasicRange<T>::isEmpty() const
+{
+    return this->size() < 1;
+}
+
+template <typename T>
+constexpr T BasicRange<T>::last() const
+{
+    return this->at(this->size() - 1);
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::size_type BasicRange<T>::length() const
+{
+    return this->size();
+}
+
+template <typename T>
+constexpr void BasicRange<T>::prepend(T value)
+{
+    this->m_step = this->m_step * (this->m_stop - value)
+                   / (this->m_stop - this->m_start + this->m_step);
+
+    this->m_start = value;
+}
+
+template <typename T>
+constexpr void BasicRange<T>::push_back(T value)
+{
+    this->append(value);
+}
+
+template <typename T>
+constexpr void BasicRange<T>::push_front(T value)
+{
+    this->prepend(value);
+}
+
+// The same elements in the opposite order. The reversed range stops a step
+// past the start, or at the end of T when that step would wrap around, so a
+// range that starts at the smallest value of T (the largest one for
+// descending ranges) can't be reversed.
+// The steps of unsigned ranges can't be negative, so they can't be reversed
+// either.
+template <typename T>
+constexpr BasicRange<T> BasicRange<T>::reversed() const
+{
+    Q_STATIC_ASSERT_X(std::is_signed<T>::value,
+                      "Unsigned ranges can't be reversed");
+
+    return this->reversedRange();
+}
+
+template <typename T>
+constexpr void BasicRange<T>::setStart(T start)
+{
+    this->m_start = start;
+}
+
+template <typename T>
+constexpr void BasicRange<T>::setStop(T stop)
+{
+    this->m_stop = stop;
+}
+
+template <typename T>
+constexpr void BasicRange<T>::setStep(T step)
+{
+    this->m_step = step;
+}
+
+template <typename T>
+constexpr typename BasicRange<T>::size_type BasicRange<T>::size() const
+{
+    return RangeTraits<T>::size(this->m_start, this->m_stop, this->m_step);
+}
+
+// The elements with indexes in [i, j).
+template <typename T>
+constexpr BasicRange<T> BasicRange<T>::slice(typename BasicRange<T>::size_type i,
+                                             typename BasicRange<T>::size_type j) const
+{
+    size_type size = this->size();
+    i = qBound<size_type>(0, i, size);
+    j = qBound<size_type>(i, j, size);
+
+    return BasicRange<T>(this->at(i),
+                         j < size? this->at(j): this->m_stop,
+                         this->m_step);
+}
+
+// Cut the range in n consecutive sub-ranges, with sizes differing at most by
+// one element.
+template <typename T>
+QVector<BasicRange<T>> BasicRange<T>::split(int n) const
+{
+    size_type size = this->size();
+    n = int(qBound<size_type>(1, n, qMax<size_type>(size, 1)));
+    size_type grain = size / n;
+    size_type remainder = size % n;
+    QVector<BasicRange<T>> parts(n);
+    size_type pos = 0;
+
+    for (int i = 0; i < n; i++) {
+        size_type partSize = i < remainder? grain + 1: grain;
+        T start = this->at(pos);
+        T stop = i < n - 1? this->at(pos + partSize): this->m_stop;
+        parts[i] = BasicRange<T>(start, stop, this->m_step);
+        pos += partSize;
+    }
+
+    return parts;
+}
+
+template <typename T>
+constexpr T BasicRange<T>::start() const
+{
+    return this->m_start;
+}
+
+template <typename T>
+constexpr T &BasicRange<T>::start()
+{
+    return this->m_start;
+}
+
+template <typename T>
+constexpr T BasicRange<T>::stop() const
+{
+    return this->m_stop;
+}
+
+template <typename T>
+constexpr T &BasicRange<T>::stop()
+{
+    return this->m_stop;
+}
+
+template <typename T>
+constexpr T BasicRange<T>::step() const
+{
+    return this->m_step;
+}
+
+template <typename T>
+constexpr T &BasicRange<T>::step()
+{
+    return this->m_step;
+}
+
+// Every k-th element, starting from the first one.
+template <typename T>
+constexpr BasicRange<T> BasicRange<T>::stride(typename BasicRange<T>::size_type k) const
+{
+    // Any k past the last element only keeps the first one, and its step
+    // could overflow.
+    if (k >= this->size())
+        return this->slice(0, 1);
+
+    return BasicRange<T>(this->m_start,
+                         this->m_stop,
+                         RangeTraits<T>::multiplyStep(this->m_step,
+                                                      qMax<size_type>(k, 1)));
+}
+
+template <typename T>
+QList<T> BasicRange<T>::toList() const
+{
+    QList<T> list;
+    size_type size = this->size();
+    Q_ASSERT_X(size <= std::numeric_limits<int>::max(),
+               "BasicRange::toList",
+               "the range doesn't fit in a QList");
+    list.reserve(static_cast<int>(size));
+
+    for (size_type i = 0; i < size; i++)
+        list << this->at(i);
+
+    return list;
+}
+
+template <typename T>
+QVector<T> BasicRange<T>::toVector() const
+{
+    QVector<T> vector;
+    this->fillInto(vector);
+
+    return vector;
+}
+
+template <typename T>
+constexpr T BasicRange<T>::value(typename BasicRange<T>::size_type i) const
+{
+    i = qBound<size_type>(0, i, this->size() - 1);
+
+    return this->at(i);
+}
+
+template <typename T>
+constexpr T BasicRange<T>::value(typename BasicRange<T>::size_type i, T defaultValue) const
+{
+    if (i < 0
+        || i >= this->size())
+        return defaultValue;
+
+    return this->at(i);
+}
+
+template <typename T>
+constexpr bool BasicRange<T>::operator !=(const BasicRange<T> &other) const
+{
+    return !(*this == other);
+}
+
+template <typename T>
+constexpr BasicRange<T> &BasicRange<T>::operator <<(T value)
+{
+    this->append(value);
+
+    return *this;
+}
+
+template <typename T>
+constexpr bool BasicRange<T>::operator ==(const BasicRange<T> &other) const
+{
+    return this->m_start == other.m_start
+           && this->m_stop == other.m_stop
+           && this->m_step == other.m_step;
+}
+
+template <typename T>
+constexpr T BasicRange<T>::operator [](typename BasicRange<T>::size_type i) const
+{
+    return this->at(i);
+}
+
+// The same elements in ascending order.
+template <typename T>
+constexpr BasicRange<T> BasicRange<T>::ascending() const
+{
+    if (this->m_step > T(0))
+        return *this;
+
+    return this->reversedRange();
+}
+
+// reversed() without the check for unsigned ranges, ascending() only
+// reverses ranges with negative steps.
+template <typename T>
+constexpr BasicRange<T> BasicRange<T>::reversedRange() const
+{
+    if (this->isEmpty())
+        return BasicRange<T>(this->m_start, this->m_start, -this->m_step);
+
+    T stop = RangeTraits<T>::next(this->m_start, -this->m_step);
+    Q_ASSERT_X(stop != this->m_start,
+               "BasicRange::reversed",
+               "the range starts at the end of its type");
+
+    return BasicRange<T>(this->last(), stop, -this->m_step);
+}
+
+// Finds the elements of this range, which must be ascending, that are also
+// in other. They are returned as count indexes starting at first and
+// separated by step.
+// The common elements solve start + i * m_step = other.start + j * other.step,
+// that is, i * m_step = other.start - start (mod other.step), which has
+// solutions only if gcd(m_step, other.step) divides other.start - start.
+template <typename T>
+constexpr bool BasicRange<T>::intersectIndexes(const BasicRange<T> &other,
+                                               size_type *first,
+                                               size_type *count,
+                                               size_type *step) const
+{
+    Q_STATIC_ASSERT_X(std::is_integral<T>::value,
+                      "Only integer ranges can be intersected");
+    typedef typename std::make_unsigned<T>::type UnsignedType;
+
+    BasicRange<T> b = other.ascending();
+    size_type size = this->size();
+    size_type otherSize = b.size();
+
+    if (size < 1 || otherSize < 1)
+        return false;
+
+    T lastA = this->at(size - 1);
+    T lastB = b.at(otherSize - 1);
+
+    if (b.m_start > lastA || this->m_start > lastB)
+        return false;
+
+    quint64 stepA = quint64(UnsignedType(this->m_step));
+    quint64 stepB = quint64(UnsignedType(b.m_step));
+    quint64 residue = b.m_start >= this->m_start?
+                          quint64(UnsignedType(b.m_start)
+                                  - UnsignedType(this->m_start)) % stepB:
+                          (stepB
+                           - quint64(UnsignedType(this->m_start)
+                                     - UnsignedType(b.m_start)) % stepB)
+                          % stepB;
+    quint64 g = RangeMath::gcd(stepA, stepB);
+
+    if (residue % g)
+        return false;
+
+    quint64 m = stepB / g;
+    quint64 i0 = m > 1?
+                     RangeMath::mulMod(residue / g,
+                                       RangeMath::inverse((stepA / g) % m, m),
+                                       m):
+                     0;
+
+    // Indexes of this range inside other.
+    size_type begin = b.m_start > this->m_start?
+                          size_type((quint64(UnsignedType(b.m_start)
+                                             - UnsignedType(this->m_start))
+                                     + stepA - 1) / stepA):
+                          0;
+    size_type end = lastB < lastA?
+                        size_type(quint64(UnsignedType(lastB)
+                                          - UnsignedType(this->m_start))
+                                  / stepA) + 1:
+                        size;
+
+    if (i0 >= quint64(end))
+        return false;
+
+    // The first solution not before begin.
+    quint64 i = i0;
+
+    if (i < quint64(begin))
+        i += (quint64(begin) - i + m - 1) / m * m;
+
+    if (i >= quint64(end))
+        return false;
+
+    *first = size_type(i);
+    *count = size_type((quint64(end) - 1 - i) / m + 1);
+    *step = *count > 1? size_type(m): 1;
+
+    return true;
+}
+
+template <typename T>
+QDebug operator <<(QDebug debug, const BasicRange<T> &range)
+{
+    debug.nospace() << "Range("
+                    << range.start()
+                    << ", "
+                    << range.stop()
+                    << ", "
+                    << range.step()
+                    << ")";
+
+    return debug.space();
+}
+
+template <typename T>
+QDataStream &operator >>(QDataStream &istream, BasicRange<T> &range)
+{
+    istream >> range.start();
+    istream >> range.stop();
+    istream >> range.step();
+
+    return istream;
+}
+
+template <typename T>
+QDataStream &operator <<(QDataStream &ostream, const BasicRange<T> &range)
+{
+    ostream << range.start();
+    ostream << range.stop();
+    ostream << range.step();
+
+    return ostream;
+}
+
+// Ranges and iterators must stay plain values, QtConcurrent copies them all
+// the time.
+Q_STATIC_ASSERT(std::is_trivially_copyable<Range>::value);
+Q_STATIC_ASSERT(std::is_trivially_copyable<Range::iterator>::value);
+Q_STATIC_ASSERT(std::is_trivially_copyable<Range::const_iterator>::value);
 
 #endif // QBRANGE_H
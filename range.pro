@@ -22,12 +22,47 @@ QT += core concurrent
 QT -= gui
 
 TARGET = range
-CONFIG += console
+CONFIG += console c++14
 CONFIG -= app_bundle
 
 TEMPLATE = app
 
+# libnuma is optional, without it the NUMA topology is read from sysfs.
+unix:exists(/usr/include/numa.h) {
+    DEFINES += HAVE_LIBNUMA
+    LIBS += -lnuma
+}
+
+# qmake CONFIG+=range_trace records every task the parallel loops run, see
+# trace.h.
+range_trace: DEFINES += RANGE_TRACE
+
 SOURCES += main.cpp \
-    range.cpp
+    affinity.cpp \
+    curve.cpp \
+    indexset.cpp \
+    kernels.cpp \
+    mapped.cpp \
+    parallel.cpp \
+    reduction.cpp \
+    stream.cpp \
+    trace.cpp \
+    workstealing.cpp
 
-HEADERS += range.h
+HEADERS += \
+    affinity.h \
+    curve.h \
+    histogram.h \
+    indexset.h \
+    kernels.h \
+    mapped.h \
+    pairwise.h \
+    parallel.h \
+    pipeline.h \
+    range.h \
+    rangend.h \
+    reduction.h \
+    scan.h \
+    stream.h \
+    trace.h \
+    workstealing.h
@@ -0,0 +1,265 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef RANGEND_H
+#define RANGEND_H
+
+#include <array>
+
+#include "parallel.h"
+
+// A N-dimensional range, the cartesian product of a Range per axis. Axis 0 is
+// the outermost one and axis N - 1 the innermost, so walking it in row-major
+// order walks a row-major buffer contiguously.
+template <int N, typename T=RangeType>
+class RangeND
+{
+    public:
+        typedef BasicRange<T> Axis;
+        typedef std::array<T, N> Index;
+        typedef std::array<typename Axis::size_type, N> Shape;
+
+        constexpr RangeND();
+        template <typename... Axes>
+        constexpr RangeND(const Axes &...axes);
+        constexpr const Axis &axis(int i) const;
+        constexpr Axis &axis(int i);
+        template <typename Function>
+        void forEach(Function function) const;
+        constexpr bool isEmpty() const;
+        constexpr Shape shape() const;
+        constexpr qint64 size() const;
+        QVector<RangeND> tiles(const Shape &tileShape) const;
+        constexpr bool operator ==(const RangeND &other) const;
+        constexpr bool operator !=(const RangeND &other) const;
+
+    private:
+        Axis m_axes[N];
+
+        template <int A, typename Function>
+        void forEachAxis(Index &index,
+                         Function &function,
+                         std::integral_constant<int, A>) const;
+        template <typename Function>
+        void forEachAxis(Index &index,
+                         Function &function,
+                         std::integral_constant<int, N>) const;
+        template <int A>
+        void tilesAxis(const QVector<Axis> (&chunks)[N],
+                       RangeND &tile,
+                       QVector<RangeND> &tiles,
+                       std::integral_constant<int, A>) const;
+        void tilesAxis(const QVector<Axis> (&chunks)[N],
+                       RangeND &tile,
+                       QVector<RangeND> &tiles,
+                       std::integral_constant<int, N>) const;
+};
+
+typedef RangeND<2> Range2D;
+typedef RangeND<3> Range3D;
+
+template <int N, typename T>
+constexpr RangeND<N, T>::RangeND()
+{
+}
+
+template <int N, typename T>
+template <typename... Axes>
+constexpr RangeND<N, T>::RangeND(const Axes &...axes):
+    m_axes{axes...}
+{
+    Q_STATIC_ASSERT_X(sizeof...(Axes) == N, "A range is needed for every axis");
+}
+
+template <int N, typename T>
+constexpr const typename RangeND<N, T>::Axis &RangeND<N, T>::axis(int i) const
+{
+    return this->m_axes[i];
+}
+
+template <int N, typename T>
+constexpr typename RangeND<N, T>::Axis &RangeND<N, T>::axis(int i)
+{
+    return this->m_axes[i];
+}
+
+// Calls function(const Index &index) for every point, in row-major order.
+template <int N, typename T>
+template <typename Function>
+void RangeND<N, T>::forEach(Function function) const
+{
+    Index index;
+    this->forEachAxis(index, function, std::integral_constant<int, 0>());
+}
+
+template <int N, typename T>
+constexpr bool RangeND<N, T>::isEmpty() const
+{
+    return this->size() < 1;
+}
+
+template <int N, typename T>
+constexpr typename RangeND<N, T>::Shape RangeND<N, T>::shape() const
+{
+    Shape shape {};
+
+    for (int i = 0; i < N; i++)
+        shape[i] = this->m_axes[i].size();
+
+    return shape;
+}
+
+template <int N, typename T>
+constexpr qint64 RangeND<N, T>::size() const
+{
+    qint64 size = 1;
+
+    for (int i = 0; i < N; i++)
+        size *= this->m_axes[i].size();
+
+    return size;
+}
+
+// Cut the range in blocks of tileShape points, the tiles at the end of every
+// axis may be smaller. Tiles are given in row-major order, sized so the
+// points a worker walks fit in cache.
+template <int N, typename T>
+QVector<RangeND<N, T>> RangeND<N, T>::tiles(const Shape &tileShape) const
+{
+    QVector<Axis> chunks[N];
+
+    for (int i = 0; i < N; i++)
+        chunks[i] = this->m_axes[i].chunks(tileShape[i]);
+
+    QVector<RangeND> tiles;
+    RangeND tile;
+    this->tilesAxis(chunks, tile, tiles, std::integral_constant<int, 0>());
+
+    return tiles;
+}
+
+template <int N, typename T>
+constexpr bool RangeND<N, T>::operator ==(const RangeND &other) const
+{
+    for (int i = 0; i < N; i++)
+        if (this->m_axes[i] != other.m_axes[i])
+            return false;
+
+    return true;
+}
+
+template <int N, typename T>
+constexpr bool RangeND<N, T>::operator !=(const RangeND &other) const
+{
+    return !(*this == other);
+}
+
+template <int N, typename T>
+template <int A, typename Function>
+void RangeND<N, T>::forEachAxis(Index &index,
+                                Function &function,
+                                std::integral_constant<int, A>) const
+{
+    for (T i: this->m_axes[A]) {
+        index[A] = i;
+        this->forEachAxis(index,
+                          function,
+                          std::integral_constant<int, A + 1>());
+    }
+}
+
+template <int N, typename T>
+template <typename Function>
+void RangeND<N, T>::forEachAxis(Index &index,
+                                Function &function,
+                                std::integral_constant<int, N>) const
+{
+    function(const_cast<const Index &>(index));
+}
+
+template <int N, typename T>
+template <int A>
+void RangeND<N, T>::tilesAxis(const QVector<Axis> (&chunks)[N],
+                              RangeND &tile,
+                              QVector<RangeND> &tiles,
+                              std::integral_constant<int, A>) const
+{
+    for (const Axis &chunk: chunks[A]) {
+        tile.m_axes[A] = chunk;
+        this->tilesAxis(chunks,
+                        tile,
+                        tiles,
+                        std::integral_constant<int, A + 1>());
+    }
+}
+
+template <int N, typename T>
+void RangeND<N, T>::tilesAxis(const QVector<Axis> (&chunks)[N],
+                              RangeND &tile,
+                              QVector<RangeND> &tiles,
+                              std::integral_constant<int, N>) const
+{
+    Q_UNUSED(chunks)
+    tiles << tile;
+}
+
+template <int N, typename T>
+QDebug operator <<(QDebug debug, const RangeND<N, T> &range)
+{
+    debug.nospace() << "RangeND(";
+
+    for (int i = 0; i < N; i++) {
+        if (i > 0)
+            debug.nospace() << ", ";
+
+        debug.nospace() << range.axis(i);
+    }
+
+    debug.nospace() << ")";
+
+    return debug.space();
+}
+
+// Runs function(const RangeND &tile) over the tiles of range in the global
+// thread pool, every worker walks a whole tile.
+template <int N, typename T, typename Function>
+void parallelFor(const RangeND<N, T> &range,
+                 const typename RangeND<N, T>::Shape &tileShape,
+                 Function function)
+{
+    QVector<RangeND<N, T>> tiles = range.tiles(tileShape);
+
+    if (tiles.size() < 2) {
+        for (const RangeND<N, T> &tile: tiles) {
+            TRACE_SCOPE("parallelFor/tile", tile.size());
+            function(tile);
+        }
+
+        return;
+    }
+
+    QtConcurrent::blockingMap(tiles, [&function] (RangeND<N, T> &tile) {
+        TRACE_SCOPE("parallelFor/tile", tile.size());
+        function(tile);
+    });
+}
+
+#endif // RANGEND_H
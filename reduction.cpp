@@ -0,0 +1,135 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#include "reduction.h"
+
+ReductionContext::ReductionContext()
+{
+    this->m_partials.data = nullptr;
+    this->m_partials.capacity = 0;
+}
+
+ReductionContext::~ReductionContext()
+{
+    this->clear();
+}
+
+qint64 ReductionContext::capacity() const
+{
+    qint64 capacity = this->m_partials.capacity;
+
+    for (const Buffer &buffer: this->m_scratch)
+        capacity += buffer.capacity;
+
+    return capacity;
+}
+
+void ReductionContext::clear()
+{
+    for (const Buffer &buffer: this->m_scratch)
+        qFreeAligned(buffer.data);
+
+    this->m_scratch.clear();
+    qFreeAligned(this->m_partials.data);
+    this->m_partials.data = nullptr;
+    this->m_partials.capacity = 0;
+}
+
+void *ReductionContext::scratch(int slot, qint64 bytes)
+{
+    Q_ASSERT_X(slot >= 0, "ReductionContext::scratch", "negative slot");
+
+    if (slot >= this->m_scratch.size())
+        this->m_scratch.resize(slot + 1);
+
+    return reserve(&this->m_scratch[slot], bytes);
+}
+
+void *ReductionContext::reserve(Buffer *buffer, qint64 bytes)
+{
+    if (bytes <= buffer->capacity)
+        return buffer->data;
+
+    // Grow at least by half, so buffers that grow a bit on every call don't
+    // reallocate every time.
+    qint64 capacity = qMax(bytes, buffer->capacity + buffer->capacity / 2);
+    capacity = (capacity + REDUCTION_CACHE_LINE - 1)
+               & ~qint64(REDUCTION_CACHE_LINE - 1);
+    qFreeAligned(buffer->data);
+    buffer->data = qMallocAligned(size_t(capacity), REDUCTION_CACHE_LINE);
+    Q_CHECK_PTR(buffer->data);
+    buffer->capacity = capacity;
+
+    return buffer->data;
+}
+
+ReductionPool::ReductionPool(int maxIdle):
+    m_maxIdle(qMax(maxIdle, 0))
+{
+}
+
+ReductionPool::~ReductionPool()
+{
+    qDeleteAll(this->m_idle);
+}
+
+ReductionContext *ReductionPool::acquire()
+{
+    QMutexLocker locker(&this->m_mutex);
+
+    if (this->m_idle.isEmpty())
+        return new ReductionContext;
+
+    ReductionContext *context = this->m_idle.last();
+    this->m_idle.removeLast();
+
+    return context;
+}
+
+void ReductionPool::release(ReductionContext *context)
+{
+    if (!context)
+        return;
+
+    {
+        QMutexLocker locker(&this->m_mutex);
+
+        if (this->m_idle.size() < this->m_maxIdle) {
+            this->m_idle << context;
+
+            return;
+        }
+    }
+
+    delete context;
+}
+
+int ReductionPool::maxIdle() const
+{
+    return this->m_maxIdle;
+}
+
+ReductionPool *ReductionPool::globalInstance()
+{
+    static ReductionPool pool;
+
+    return &pool;
+}
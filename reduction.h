@@ -0,0 +1,221 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+#include <new>
+#include <QMutex>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include "range.h"
+#include "trace.h"
+
+// Alignment of the scratch buffers, and size the partial results are padded
+// to so no two threads write in the same cache line.
+#define REDUCTION_CACHE_LINE 64
+
+template <typename T>
+struct alignas(REDUCTION_CACHE_LINE) ReductionPartial
+{
+    T value;
+};
+
+// Memory a reduction needs between calls: numbered scratch buffers aligned to
+// REDUCTION_CACHE_LINE, and one padded partial result per thread.
+// Buffers only grow, so a context reused for reductions of the same or
+// smaller size doesn't allocate memory again.
+// Reductions that use different contexts can run at the same time, a single
+// context must not be used by two of them at once.
+class ReductionContext
+{
+    public:
+        ReductionContext();
+        ~ReductionContext();
+
+        // Same as parallelBlockReduce(), with the partial results of the
+        // blocks in the context.
+        template <typename T,
+                  typename BlockFunction,
+                  typename CombineFunction,
+                  typename R>
+        T blockReduce(const BasicRange<R> &range,
+                      BlockFunction reduceBlock,
+                      CombineFunction combine);
+
+        // Bytes held by the context.
+        qint64 capacity() const;
+
+        // Frees every buffer.
+        void clear();
+
+        // Same as parallelReduce(), with the partial results of the blocks in
+        // the context.
+        template <typename T,
+                  typename MapFunction,
+                  typename CombineFunction,
+                  typename R>
+        T reduce(const BasicRange<R> &range,
+                 const T &init,
+                 MapFunction map,
+                 CombineFunction combine);
+
+        // Returns the scratch buffer number slot with room for at least bytes
+        // bytes. The contents are kept only while the buffer doesn't grow.
+        void *scratch(int slot, qint64 bytes);
+
+        template <typename T>
+        T *scratch(int slot, qint64 size)
+        {
+            return static_cast<T *>(this->scratch(slot, size * qint64(sizeof(T))));
+        }
+
+    private:
+        struct Buffer
+        {
+            void *data;
+            qint64 capacity;
+        };
+
+        QVector<Buffer> m_scratch;
+        Buffer m_partials;
+        QVector<int> m_blocks;
+
+        static void *reserve(Buffer *buffer, qint64 bytes);
+
+        Q_DISABLE_COPY(ReductionContext)
+};
+
+// Keeps idle contexts, so independent reductions running at the same time
+// take one each and give it back when done, instead of allocating their
+// scratch on every call.
+class ReductionPool
+{
+    public:
+        explicit ReductionPool(int maxIdle=QThread::idealThreadCount());
+        ~ReductionPool();
+
+        // Returns an idle context, or a new one if there is none. It must be
+        // given back with release().
+        ReductionContext *acquire();
+
+        // Keeps context for a later acquire(), or deletes it if there are
+        // already maxIdle() idle contexts.
+        void release(ReductionContext *context);
+
+        int maxIdle() const;
+        static ReductionPool *globalInstance();
+
+    private:
+        QMutex m_mutex;
+        QVector<ReductionContext *> m_idle;
+        int m_maxIdle;
+
+        Q_DISABLE_COPY(ReductionPool)
+};
+
+template <typename T,
+          typename BlockFunction,
+          typename CombineFunction,
+          typename R>
+T ReductionContext::blockReduce(const BasicRange<R> &range,
+                                BlockFunction reduceBlock,
+                                CombineFunction combine)
+{
+    typedef typename BasicRange<R>::size_type size_type;
+
+    size_type size = range.size();
+    int n = int(qBound<size_type>(1,
+                                  QThreadPool::globalInstance()->maxThreadCount(),
+                                  qMax<size_type>(size, 1)));
+    size_type grain = size / n;
+    size_type remainder = size % n;
+
+    // The blocks are cut the same way as BasicRange::split(), without
+    // storing them.
+    auto block = [&range, grain, remainder] (int i) {
+        size_type start = i * grain + qMin<size_type>(i, remainder);
+
+        return range.slice(start, start + grain + (i < remainder? 1: 0));
+    };
+
+    auto partials =
+            static_cast<ReductionPartial<T> *>(reserve(&this->m_partials,
+                                                       n * qint64(sizeof(ReductionPartial<T>))));
+
+    auto runBlock = [&reduceBlock, &block, partials] (int i) {
+        BasicRange<R> part = block(i);
+        TRACE_SCOPE("ReductionContext", part.size());
+        new (&partials[i].value) T(reduceBlock(part));
+    };
+
+    if (n < 2) {
+        runBlock(0);
+    } else {
+        if (this->m_blocks.size() < n) {
+            this->m_blocks.resize(n);
+
+            for (int i = 0; i < n; i++)
+                this->m_blocks[i] = i;
+        }
+
+        QtConcurrent::blockingMap(this->m_blocks.begin(),
+                                  this->m_blocks.begin() + n,
+                                  runBlock);
+    }
+
+    T result = partials[0].value;
+
+    for (int i = 1; i < n; i++)
+        result = combine(result, partials[i].value);
+
+    for (int i = 0; i < n; i++)
+        partials[i].value.~T();
+
+    return result;
+}
+
+template <typename T,
+          typename MapFunction,
+          typename CombineFunction,
+          typename R>
+T ReductionContext::reduce(const BasicRange<R> &range,
+                           const T &init,
+                           MapFunction map,
+                           CombineFunction combine)
+{
+    return this->blockReduce<T>(range,
+                                [&init, &map, &combine] (const BasicRange<R> &block) {
+        T accumulator = init;
+        R start = block.start();
+        R step = block.step();
+        qint64 size = block.size();
+
+        for (qint64 i = 0; i < size; i++)
+            accumulator = combine(accumulator,
+                                  map(RangeTraits<R>::at(start, step, i)));
+
+        return accumulator;
+    }, combine);
+}
+
+#endif // REDUCTION_H
@@ -0,0 +1,160 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include "range.h"
+#include "trace.h"
+
+// Blocked prefix sums over the elements of input indexed by range:
+//
+// 1. The range is split in one block per thread and every thread sums its
+//    block.
+// 2. The block sums are scanned serially, giving every block its offset.
+// 3. Every thread scans its block again starting from its offset, writing
+//    the results to output.
+//
+// The input is read twice and the output written once, and since every
+// element is read before being written, input and output can be the same
+// buffer.
+template <typename T>
+void parallelScan(const Range &range,
+                  const T *input,
+                  T *output,
+                  T init,
+                  bool inclusive)
+{
+    struct Block
+    {
+        Range range;
+        T sum;
+    };
+
+    QVector<Range> ranges =
+            range.split(QThreadPool::globalInstance()->maxThreadCount());
+    QVector<Block> blocks(ranges.size());
+
+    for (int i = 0; i < ranges.size(); i++)
+        blocks[i].range = ranges[i];
+
+    QtConcurrent::blockingMap(blocks, [input] (Block &block) {
+        TRACE_SCOPE("parallelScan/sum", block.range.size());
+        T sum = 0;
+
+        if (block.range.step() == 1) {
+            const T *in = input + block.range.start();
+            qint64 size = block.range.size();
+
+            for (qint64 i = 0; i < size; i++)
+                sum += in[i];
+        } else {
+            for (int i: block.range)
+                sum += input[i];
+        }
+
+        block.sum = sum;
+    });
+
+    T offset = init;
+
+    for (Block &block: blocks) {
+        T sum = block.sum;
+        block.sum = offset;
+        offset += sum;
+    }
+
+    QtConcurrent::blockingMap(blocks, [input, output, inclusive] (Block &block) {
+        TRACE_SCOPE("parallelScan/write", block.range.size());
+        T sum = block.sum;
+
+        if (block.range.step() == 1) {
+            const T *in = input + block.range.start();
+            T *out = output + block.range.start();
+            qint64 size = block.range.size();
+
+            if (inclusive)
+                for (qint64 i = 0; i < size; i++) {
+                    sum += in[i];
+                    out[i] = sum;
+                }
+            else
+                for (qint64 i = 0; i < size; i++) {
+                    T value = in[i];
+                    out[i] = sum;
+                    sum += value;
+                }
+        } else {
+            for (int i: block.range) {
+                T value = input[i];
+
+                if (inclusive) {
+                    sum += value;
+                    output[i] = sum;
+                } else {
+                    output[i] = sum;
+                    sum += value;
+                }
+            }
+        }
+    });
+}
+
+// output[i] = init + input[range[0]] + ... + input[i], for every i in range.
+template <typename T>
+void parallelInclusiveScan(const Range &range,
+                           const T *input,
+                           T *output,
+                           T init=0)
+{
+    parallelScan(range, input, output, init, true);
+}
+
+// output[i] = init + input[range[0]] + ... + input[i - step], for every i in
+// range.
+template <typename T>
+void parallelExclusiveScan(const Range &range,
+                           const T *input,
+                           T *output,
+                           T init=0)
+{
+    parallelScan(range, input, output, init, false);
+}
+
+// In place scans of the whole buffer.
+template <typename T>
+void parallelInclusiveScan(QVector<T> &buffer)
+{
+    T *data = buffer.data();
+    parallelScan(Range(buffer.size()), data, data, T(0), true);
+}
+
+template <typename T>
+void parallelExclusiveScan(QVector<T> &buffer)
+{
+    T *data = buffer.data();
+    parallelScan(Range(buffer.size()), data, data, T(0), false);
+}
+
+#endif // SCAN_H
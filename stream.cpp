@@ -0,0 +1,305 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#include <QMutex>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "stream.h"
+#include "trace.h"
+
+class RangeStreamState
+{
+    public:
+        RangeStreamState(const Range &range,
+                         qint64 grain,
+                         int window,
+                         const RangeStreamFunction &process,
+                         const RangeStreamFunction &consume):
+            m_range(range),
+            m_grain(grain),
+            m_chunkCount((range.size() + grain - 1) / grain),
+            m_window(window),
+            m_process(process),
+            m_consume(consume),
+            m_processed(window, false),
+            m_submitted(0),
+            m_consumed(0),
+            m_inFlight(0),
+            m_maxInFlight(0),
+            m_consuming(false),
+            m_canceled(false)
+        {
+        }
+
+        Range chunk(qint64 index) const
+        {
+            return this->m_range.slice(index * this->m_grain,
+                                       (index + 1) * this->m_grain);
+        }
+
+        // Called with the mutex locked, returns the number of chunks to
+        // start outside of the lock.
+        int reserveChunks();
+        void startChunks(const QSharedPointer<RangeStreamState> &self,
+                         qint64 first,
+                         int count);
+        void runChunk(const QSharedPointer<RangeStreamState> &self,
+                      qint64 index);
+        bool finished() const
+        {
+            return this->m_canceled?
+                        this->m_inFlight == 0:
+                        this->m_consumed == this->m_chunkCount;
+        }
+
+        Range m_range;
+        qint64 m_grain;
+        qint64 m_chunkCount;
+        int m_window;
+        RangeStreamFunction m_process;
+        RangeStreamFunction m_consume;
+        mutable QMutex m_mutex;
+        QWaitCondition m_finished;
+
+        // Processed chunks waiting to be consumed, indexed by
+        // index % window, at most window chunks are in flight.
+        QVector<bool> m_processed;
+        qint64 m_submitted;
+        qint64 m_consumed;
+        int m_inFlight;
+        int m_maxInFlight;
+        bool m_consuming;
+        bool m_canceled;
+};
+
+class RangeStreamWorker: public QRunnable
+{
+    public:
+        RangeStreamWorker(const QSharedPointer<RangeStreamState> &state,
+                          qint64 index):
+            m_state(state),
+            m_index(index)
+        {
+        }
+
+        void run()
+        {
+            this->m_state->runChunk(this->m_state, this->m_index);
+        }
+
+    private:
+        QSharedPointer<RangeStreamState> m_state;
+        qint64 m_index;
+};
+
+int RangeStreamState::reserveChunks()
+{
+    if (this->m_canceled)
+        return 0;
+
+    qint64 count = qMin<qint64>(this->m_window - this->m_inFlight,
+                                this->m_chunkCount - this->m_submitted);
+    this->m_submitted += count;
+    this->m_inFlight += int(count);
+    this->m_maxInFlight = qMax(this->m_maxInFlight, this->m_inFlight);
+
+    return int(count);
+}
+
+// Chunks that find no free thread in the pool run in the calling thread,
+// the caller may be a pool thread waiting for them.
+void RangeStreamState::startChunks(const QSharedPointer<RangeStreamState> &self,
+                                   qint64 first,
+                                   int count)
+{
+    QThreadPool *pool = QThreadPool::globalInstance();
+
+    for (int i = 0; i < count; i++) {
+        RangeStreamWorker *worker = new RangeStreamWorker(self, first + i);
+
+        if (!pool->tryStart(worker)) {
+            delete worker;
+            this->runChunk(self, first + i);
+        }
+    }
+}
+
+void RangeStreamState::runChunk(const QSharedPointer<RangeStreamState> &self,
+                                qint64 index)
+{
+    {
+        Range chunk = this->chunk(index);
+        TRACE_SCOPE("streamFor/process", chunk.size());
+        this->m_process(index, chunk);
+    }
+
+    QMutexLocker locker(&this->m_mutex);
+    this->m_processed[int(index % this->m_window)] = true;
+
+    // Only one thread consumes at a time, the others leave their chunk
+    // marked as processed and it gets consumed in order.
+    if (this->m_consuming)
+        return;
+
+    this->m_consuming = true;
+
+    forever {
+        int slot = int(this->m_consumed % this->m_window);
+
+        if (this->m_consumed >= this->m_submitted
+            || !this->m_processed[slot])
+            break;
+
+        qint64 consumed = this->m_consumed;
+
+        if (!this->m_canceled) {
+            locker.unlock();
+
+            {
+                Range chunk = this->chunk(consumed);
+                TRACE_SCOPE("streamFor/consume", chunk.size());
+                this->m_consume(consumed, chunk);
+            }
+
+            locker.relock();
+        }
+
+        this->m_processed[slot] = false;
+        this->m_consumed++;
+        this->m_inFlight--;
+
+        qint64 first = this->m_submitted;
+        int count = this->reserveChunks();
+
+        if (count > 0) {
+            locker.unlock();
+            this->startChunks(self, first, count);
+            locker.relock();
+        }
+    }
+
+    this->m_consuming = false;
+
+    if (this->finished())
+        this->m_finished.wakeAll();
+}
+
+RangeStream::RangeStream()
+{
+}
+
+RangeStream::RangeStream(const QSharedPointer<RangeStreamState> &state):
+    m_state(state)
+{
+}
+
+void RangeStream::cancel()
+{
+    if (!this->m_state)
+        return;
+
+    QMutexLocker locker(&this->m_state->m_mutex);
+    this->m_state->m_canceled = true;
+
+    if (this->m_state->finished())
+        this->m_state->m_finished.wakeAll();
+}
+
+qint64 RangeStream::chunkCount() const
+{
+    return this->m_state? this->m_state->m_chunkCount: 0;
+}
+
+qint64 RangeStream::chunksConsumed() const
+{
+    if (!this->m_state)
+        return 0;
+
+    QMutexLocker locker(&this->m_state->m_mutex);
+
+    return this->m_state->m_consumed;
+}
+
+bool RangeStream::isCanceled() const
+{
+    if (!this->m_state)
+        return false;
+
+    QMutexLocker locker(&this->m_state->m_mutex);
+
+    return this->m_state->m_canceled;
+}
+
+bool RangeStream::isFinished() const
+{
+    if (!this->m_state)
+        return true;
+
+    QMutexLocker locker(&this->m_state->m_mutex);
+
+    return this->m_state->finished();
+}
+
+int RangeStream::maxInFlight() const
+{
+    if (!this->m_state)
+        return 0;
+
+    QMutexLocker locker(&this->m_state->m_mutex);
+
+    return this->m_state->m_maxInFlight;
+}
+
+void RangeStream::waitForFinished()
+{
+    if (!this->m_state)
+        return;
+
+    QMutexLocker locker(&this->m_state->m_mutex);
+
+    while (!this->m_state->finished())
+        this->m_state->m_finished.wait(&this->m_state->m_mutex);
+}
+
+RangeStream streamFor(const Range &range,
+                      qint64 grain,
+                      int window,
+                      const RangeStreamFunction &process,
+                      const RangeStreamFunction &consume)
+{
+    QSharedPointer<RangeStreamState> state(new RangeStreamState(range,
+                                                                qMax<qint64>(grain, 1),
+                                                                qMax(window, 1),
+                                                                process,
+                                                                consume));
+    int count = 0;
+
+    {
+        QMutexLocker locker(&state->m_mutex);
+        count = state->reserveChunks();
+    }
+
+    state->startChunks(state, 0, count);
+
+    return RangeStream(state);
+}
@@ -0,0 +1,80 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <functional>
+#include <QSharedPointer>
+
+#include "range.h"
+
+class RangeStreamState;
+
+typedef std::function<void (qint64 index, const Range &chunk)> RangeStreamFunction;
+
+// Handle to a range running with streamFor(), in the spirit of QFuture.
+// Copies share the same stream, and the stream keeps running if every handle
+// is destroyed.
+class RangeStream
+{
+    public:
+        RangeStream();
+        explicit RangeStream(const QSharedPointer<RangeStreamState> &state);
+
+        // Stops submitting chunks. Chunks already running are processed but
+        // not consumed.
+        void cancel();
+        qint64 chunkCount() const;
+        qint64 chunksConsumed() const;
+        bool isCanceled() const;
+        bool isFinished() const;
+
+        // The biggest number of chunks that were in flight at the same time,
+        // never more than the window.
+        int maxInFlight() const;
+        void waitForFinished();
+
+    private:
+        QSharedPointer<RangeStreamState> m_state;
+};
+
+// Cuts range in chunks of grain elements and returns immediately. Chunks are
+// processed with process(index, chunk) in the global thread pool, and every
+// processed chunk is handed to consume(index, chunk) in the order of the
+// range, one at a time, so consume can be used as a per chunk completion
+// callback that writes results out.
+// A chunk is in flight from the moment it's submitted until consume returns,
+// and no more than window chunks are in flight at once. So a slow consumer
+// slows down the submission of new chunks, and any per chunk buffer lives in
+// at most window chunks (index % window can be used as a buffer slot).
+// Chunks are cut on demand, so the range can be much longer than what fits
+// in memory as a list of chunks.
+// Chunks that find no free thread in the pool are processed and consumed by
+// the thread that submits them, so streamFor() can be called from a task of
+// the pool, but then it may not return before the stream is done.
+RangeStream streamFor(const Range &range,
+                      qint64 grain,
+                      int window,
+                      const RangeStreamFunction &process,
+                      const RangeStreamFunction &consume);
+
+#endif // STREAM_H
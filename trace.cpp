@@ -0,0 +1,281 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#include <algorithm>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QtDebug>
+
+#include "trace.h"
+
+// Every thread records its events in its own buffer, so the tasks don't
+// contend for a lock. The buffers are kept after their threads finish.
+struct TraceBuffer
+{
+    QMutex mutex;
+    QVector<TraceEvent> events;
+    int thread;
+};
+
+static QAtomicInt traceRecording(0);
+static QMutex traceBuffersMutex;
+static QVector<TraceBuffer *> traceBuffers;
+
+static const QElapsedTimer &traceClock()
+{
+    static const QElapsedTimer clock = [] () {
+        QElapsedTimer clock;
+        clock.start();
+
+        return clock;
+    }();
+
+    return clock;
+}
+
+static TraceBuffer *threadBuffer()
+{
+    static thread_local TraceBuffer *buffer = nullptr;
+
+    if (!buffer) {
+        QMutexLocker locker(&traceBuffersMutex);
+        buffer = new TraceBuffer;
+        buffer->thread = traceBuffers.size();
+        traceBuffers << buffer;
+    }
+
+    return buffer;
+}
+
+TraceScope::TraceScope(const char *name, qint64 size):
+    m_name(name),
+    m_size(size),
+    m_start(traceRecording.load()? traceTimestamp(): -1)
+{
+}
+
+TraceScope::~TraceScope()
+{
+    if (this->m_start < 0)
+        return;
+
+    qint64 stop = traceTimestamp();
+    TraceBuffer *buffer = threadBuffer();
+    QMutexLocker locker(&buffer->mutex);
+    buffer->events << TraceEvent {this->m_name,
+                                  this->m_start,
+                                  stop,
+                                  this->m_size,
+                                  buffer->thread};
+}
+
+bool traceStart()
+{
+#ifdef RANGE_TRACE
+    QMutexLocker locker(&traceBuffersMutex);
+
+    for (TraceBuffer *buffer: traceBuffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        buffer->events.clear();
+    }
+
+    traceRecording.store(1);
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+void traceStop()
+{
+    traceRecording.store(0);
+}
+
+bool traceIsRecording()
+{
+    return traceRecording.load();
+}
+
+qint64 traceTimestamp()
+{
+    return traceClock().nsecsElapsed();
+}
+
+QVector<TraceEvent> traceEvents()
+{
+    QVector<TraceEvent> events;
+    QMutexLocker locker(&traceBuffersMutex);
+
+    for (TraceBuffer *buffer: traceBuffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        events << buffer->events;
+    }
+
+    std::sort(events.begin(),
+              events.end(),
+              [] (const TraceEvent &a, const TraceEvent &b) {
+        return a.start < b.start;
+    });
+
+    return events;
+}
+
+TraceStats traceStats(qint64 from, qint64 to)
+{
+    QVector<TraceEvent> events = traceEvents();
+    TraceStats stats;
+    stats.wallTime = 0;
+    stats.threads = 0;
+    stats.tasks = 0;
+    stats.minTaskSize = 0;
+    stats.maxTaskSize = 0;
+    stats.minTaskTime = 0;
+    stats.maxTaskTime = 0;
+    stats.imbalance = 0;
+    stats.overhead = 0;
+
+    qint64 first = std::numeric_limits<qint64>::max();
+    qint64 last = std::numeric_limits<qint64>::min();
+
+    // The stop of the last event counted in every thread, events are sorted
+    // by start, so nested events are only counted once.
+    QVector<qint64> counted;
+
+    for (const TraceEvent &event: events) {
+        qint64 start = qMax(event.start, from);
+        qint64 stop = qMin(event.stop, to);
+
+        if (start >= stop)
+            continue;
+
+        if (event.thread >= stats.busyTime.size()) {
+            stats.busyTime.resize(event.thread + 1);
+            counted.resize(event.thread + 1);
+        }
+
+        qint64 &threadCounted = counted[event.thread];
+
+        if (stop > threadCounted) {
+            stats.busyTime[event.thread] += stop - qMax(start, threadCounted);
+            threadCounted = stop;
+        }
+
+        qint64 time = stop - start;
+
+        if (stats.tasks < 1) {
+            stats.minTaskSize = stats.maxTaskSize = event.size;
+            stats.minTaskTime = stats.maxTaskTime = time;
+        } else {
+            stats.minTaskSize = qMin(stats.minTaskSize, event.size);
+            stats.maxTaskSize = qMax(stats.maxTaskSize, event.size);
+            stats.minTaskTime = qMin(stats.minTaskTime, time);
+            stats.maxTaskTime = qMax(stats.maxTaskTime, time);
+        }
+
+        stats.tasks++;
+        first = qMin(first, start);
+        last = qMax(last, stop);
+    }
+
+    if (stats.tasks < 1)
+        return stats;
+
+    if (from > 0)
+        first = from;
+
+    if (to < std::numeric_limits<qint64>::max())
+        last = to;
+
+    stats.wallTime = last - first;
+    qint64 busy = 0;
+    qint64 maxBusy = 0;
+
+    for (qint64 threadBusy: stats.busyTime)
+        if (threadBusy > 0) {
+            busy += threadBusy;
+            maxBusy = qMax(maxBusy, threadBusy);
+            stats.threads++;
+        }
+
+    double meanBusy = double(busy) / stats.threads;
+    stats.imbalance = meanBusy > 0? maxBusy / meanBusy - 1: 0;
+    stats.overhead = stats.wallTime > 0?
+                         1 - double(busy) / (double(stats.wallTime) * stats.threads):
+                         0;
+
+    return stats;
+}
+
+bool traceWriteChrome(const QString &fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Can't write" << fileName << file.errorString();
+
+        return false;
+    }
+
+    QVector<TraceEvent> events = traceEvents();
+    QVector<bool> threads;
+
+    // Written by hand, a QJsonDocument with millions of events takes several
+    // times the memory of the events.
+    file.write("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool firstEvent = true;
+
+    for (const TraceEvent &event: events) {
+        if (event.thread >= threads.size())
+            threads.resize(event.thread + 1);
+
+        threads[event.thread] = true;
+        file.write(QString("%1\n{\"name\":\"%2\",\"cat\":\"range\",\"ph\":\"X\","
+                           "\"ts\":%3,\"dur\":%4,\"pid\":1,\"tid\":%5,"
+                           "\"args\":{\"size\":%6}}")
+                   .arg(firstEvent? "": ",")
+                   .arg(event.name)
+                   .arg(event.start / 1.0e3, 0, 'f', 3)
+                   .arg((event.stop - event.start) / 1.0e3, 0, 'f', 3)
+                   .arg(event.thread)
+                   .arg(event.size)
+                   .toUtf8());
+        firstEvent = false;
+    }
+
+    for (int thread = 0; thread < threads.size(); thread++) {
+        if (!threads[thread])
+            continue;
+
+        file.write(QString("%1\n{\"name\":\"thread_name\",\"ph\":\"M\","
+                           "\"pid\":1,\"tid\":%2,"
+                           "\"args\":{\"name\":\"thread %2\"}}")
+                   .arg(firstEvent? "": ",")
+                   .arg(thread)
+                   .toUtf8());
+        firstEvent = false;
+    }
+
+    file.write("\n]}\n");
+
+    return true;
+}
@@ -0,0 +1,109 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <limits>
+#include <QString>
+#include <QVector>
+
+// Instrumentation of the parallel loops. Building with RANGE_TRACE defined
+// (qmake CONFIG+=range_trace) makes every chunk, block or task that the
+// loops hand to a thread record when it started and stopped, in which thread
+// and how many elements it had. Without it TRACE_SCOPE expands to nothing and
+// the loops have no instrumentation at all.
+// Recording is off until traceStart() is called.
+#ifdef RANGE_TRACE
+#define TRACE_SCOPE(name, size) TraceScope traceScope(name, size)
+#else
+#define TRACE_SCOPE(name, size)
+#endif
+
+struct TraceEvent
+{
+    // name must be a string literal, it's not copied.
+    const char *name;
+    qint64 start;
+    qint64 stop;
+    qint64 size;
+    int thread;
+};
+
+struct TraceStats
+{
+    // Nanoseconds from the start to the end of the measured interval.
+    qint64 wallTime;
+
+    // Nanoseconds every thread spent running tasks, indexed by thread.
+    QVector<qint64> busyTime;
+    int threads;
+    int tasks;
+    qint64 minTaskSize;
+    qint64 maxTaskSize;
+    qint64 minTaskTime;
+    qint64 maxTaskTime;
+
+    // Busy time of the busiest thread over the mean of the threads that
+    // ran tasks, minus 1. 0 means every thread worked the same time.
+    double imbalance;
+
+    // Fraction of the wall time times the threads that was not spent in a
+    // task: scheduling, waiting for other threads, and serial code.
+    double overhead;
+};
+
+class TraceScope
+{
+    public:
+        TraceScope(const char *name, qint64 size);
+        ~TraceScope();
+
+    private:
+        const char *m_name;
+        qint64 m_size;
+        qint64 m_start;
+
+        Q_DISABLE_COPY(TraceScope)
+};
+
+// Clears the recorded events and starts recording. Returns false, and does
+// nothing, if the project was built without RANGE_TRACE.
+bool traceStart();
+void traceStop();
+bool traceIsRecording();
+
+// Nanoseconds since an arbitrary point, in the same clock of the events.
+qint64 traceTimestamp();
+
+// Events recorded since traceStart(), sorted by start time.
+QVector<TraceEvent> traceEvents();
+
+// Statistics of the events recorded between from and to, events that cross
+// the limits count only the part inside them.
+TraceStats traceStats(qint64 from=0,
+                      qint64 to=std::numeric_limits<qint64>::max());
+
+// Writes the recorded events in the Chrome trace event format, it can be
+// opened with chrome://tracing or https://ui.perfetto.dev.
+bool traceWriteChrome(const QString &fileName);
+
+#endif // TRACE_H
@@ -0,0 +1,315 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#include <QMutex>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "trace.h"
+#include "workstealing.h"
+
+// Ranges are split in halves, so a deque never holds more than a range per
+// bit of the range size.
+#define DEQUE_SIZE 64
+
+// Every worker should be able to split its part of the range at least this
+// many times, so there is something to steal.
+#define TASKS_PER_THREAD 32
+
+// Failed attempts to find work before an idle worker goes to sleep, and the
+// longest it sleeps in case it misses the wake up of a push.
+#define IDLE_SPINS 64
+#define IDLE_SLEEP_MS 1
+
+class RangeDeque
+{
+    public:
+        RangeDeque():
+            m_top(0),
+            m_bottom(0)
+        {
+        }
+
+        // The owner pushes and pops ranges at the bottom.
+        bool push(const Range &range)
+        {
+            QMutexLocker locker(&this->m_mutex);
+
+            if (this->m_bottom == DEQUE_SIZE) {
+                if (this->m_top == 0)
+                    return false;
+
+                for (int i = this->m_top; i < this->m_bottom; i++)
+                    this->m_ranges[i - this->m_top] = this->m_ranges[i];
+
+                this->m_bottom -= this->m_top;
+                this->m_top = 0;
+            }
+
+            this->m_ranges[this->m_bottom++] = range;
+
+            return true;
+        }
+
+        bool pop(Range *range)
+        {
+            QMutexLocker locker(&this->m_mutex);
+
+            if (this->m_top == this->m_bottom)
+                return false;
+
+            *range = this->m_ranges[--this->m_bottom];
+
+            if (this->m_top == this->m_bottom)
+                this->m_top = this->m_bottom = 0;
+
+            return true;
+        }
+
+        // Thieves take the oldest range from the top.
+        bool steal(Range *range)
+        {
+            QMutexLocker locker(&this->m_mutex);
+
+            if (this->m_top == this->m_bottom)
+                return false;
+
+            *range = this->m_ranges[this->m_top++];
+
+            if (this->m_top == this->m_bottom)
+                this->m_top = this->m_bottom = 0;
+
+            return true;
+        }
+
+    private:
+        QMutex m_mutex;
+        Range m_ranges[DEQUE_SIZE];
+        int m_top;
+        int m_bottom;
+};
+
+class WorkStealingJob
+{
+    public:
+        WorkStealingJob(int workers,
+                        qint64 grain,
+                        qint64 size,
+                        const std::function<void (const Range &)> &function):
+            m_deques(new RangeDeque[workers]),
+            m_workers(workers),
+            m_grain(grain),
+            m_pending(size),
+            m_sleeping(0),
+            m_function(function)
+        {
+        }
+
+        ~WorkStealingJob()
+        {
+            delete [] this->m_deques;
+        }
+
+        void start(const Range &range)
+        {
+            QVector<Range> parts = range.split(this->m_workers);
+
+            for (int i = 0; i < parts.size(); i++)
+                this->m_deques[i].push(parts[i]);
+        }
+
+        void work(int worker)
+        {
+            quint32 seed = 2654435761u * quint32(worker + 1);
+            Range range;
+            int failures = 0;
+
+            while (this->m_pending.loadAcquire() > 0) {
+                if (this->m_deques[worker].pop(&range)
+                    || this->steal(worker, &seed, &range)) {
+                    this->run(worker, range);
+                    failures = 0;
+                } else {
+                    this->idle(&failures);
+                }
+            }
+        }
+
+    private:
+        RangeDeque *m_deques;
+        int m_workers;
+        qint64 m_grain;
+        QAtomicInteger<qint64> m_pending;
+        QAtomicInt m_sleeping;
+        QMutex m_idleMutex;
+        QWaitCondition m_wake;
+        const std::function<void (const Range &)> &m_function;
+
+        Q_DISABLE_COPY(WorkStealingJob)
+
+        // Yields for a while, the ranges being split are pushed soon, and
+        // then sleeps until a range is pushed or the job is done.
+        void idle(int *failures)
+        {
+            if (++*failures < IDLE_SPINS) {
+                QThread::yieldCurrentThread();
+
+                return;
+            }
+
+            QMutexLocker locker(&this->m_idleMutex);
+            this->m_sleeping.fetchAndAddOrdered(1);
+
+            if (this->m_pending.loadAcquire() > 0)
+                this->m_wake.wait(&this->m_idleMutex, IDLE_SLEEP_MS);
+
+            this->m_sleeping.fetchAndAddOrdered(-1);
+        }
+
+        void wake(bool all)
+        {
+            if (!all && this->m_sleeping.loadAcquire() < 1)
+                return;
+
+            QMutexLocker locker(&this->m_idleMutex);
+
+            if (all)
+                this->m_wake.wakeAll();
+            else
+                this->m_wake.wakeOne();
+        }
+
+        void run(int worker, Range range)
+        {
+            qint64 size = range.size();
+
+            while (size > this->m_grain) {
+                qint64 half = size / 2;
+                Range second(range.at(half), range.stop(), range.step());
+
+                if (!this->m_deques[worker].push(second))
+                    break;
+
+                this->wake(false);
+                range.setStop(range.at(half));
+                size = half;
+            }
+
+            {
+                TRACE_SCOPE("workStealingFor", size);
+                this->m_function(range);
+            }
+
+            if (this->m_pending.fetchAndAddRelease(-size) == size)
+                this->wake(true);
+        }
+
+        bool steal(int thief, quint32 *seed, Range *range)
+        {
+            int workers = this->m_workers;
+
+            // Start from a random victim so thieves don't all go for the
+            // same deque.
+            *seed ^= *seed << 13;
+            *seed ^= *seed >> 17;
+            *seed ^= *seed << 5;
+            int victim = int(*seed % quint32(workers));
+
+            for (int i = 0; i < workers; i++) {
+                int deque = (victim + i) % workers;
+
+                if (deque != thief && this->m_deques[deque].steal(range))
+                    return true;
+            }
+
+            return false;
+        }
+};
+
+class WorkStealingWorker: public QRunnable
+{
+    public:
+        WorkStealingWorker(WorkStealingJob *job,
+                           int worker,
+                           QSemaphore *done):
+            m_job(job),
+            m_worker(worker),
+            m_done(done)
+        {
+        }
+
+        void run()
+        {
+            this->m_job->work(this->m_worker);
+            this->m_done->release();
+        }
+
+    private:
+        WorkStealingJob *m_job;
+        int m_worker;
+        QSemaphore *m_done;
+};
+
+void workStealingFor(const Range &range,
+                     qint64 grain,
+                     const std::function<void (const Range &chunk)> &function)
+{
+    qint64 size = range.size();
+
+    if (size < 1)
+        return;
+
+    QThreadPool *pool = QThreadPool::globalInstance();
+    int workers = qMax(1, pool->maxThreadCount());
+
+    if (grain < 1)
+        grain = qMax<qint64>(1, size / (TASKS_PER_THREAD * workers));
+
+    if (workers < 2 || size <= grain) {
+        function(range);
+
+        return;
+    }
+
+    WorkStealingJob job(workers, grain, size, function);
+    job.start(range);
+    QSemaphore done;
+
+    int started = 0;
+
+    // The calling thread works as worker 0. It may be a pool thread itself,
+    // so only free threads are used, and the parts of the workers that
+    // didn't start are stolen like any other range.
+    for (int i = 1; i < workers; i++) {
+        WorkStealingWorker *worker = new WorkStealingWorker(&job, i, &done);
+
+        if (pool->tryStart(worker))
+            started++;
+        else
+            delete worker;
+    }
+
+    job.work(0);
+    done.acquire(started);
+}
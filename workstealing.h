@@ -0,0 +1,51 @@
+/* QtRangeExample, Implementation of range iterator in Qt, and usage example
+ * with QtConcurrent.
+ * Copyright (C) 2015  Gonzalo Exequiel Pedone
+ *
+ * QtRangeExample is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * QtRangeExample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with QtRangeExample. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Email   : hipersayan DOT x AT gmail DOT com
+ * Web-Site: http://github.com/hipersayanX/QtRangeExample
+ */
+
+#ifndef WORKSTEALING_H
+#define WORKSTEALING_H
+
+#include <functional>
+
+#include "range.h"
+
+// Runs function(const Range &chunk) over range with a work stealing
+// scheduler on top of the global thread pool.
+// Every worker owns a deque of sub-ranges. A worker takes the newest range of
+// its deque, and while it is bigger than grain, splits it in half, pushes the
+// second half and keeps going with the first one. Idle workers steal the
+// oldest (and so biggest) range from other workers, which balances irregular
+// per index costs without any shared queue. Idle workers sleep until a
+// range is pushed.
+// The calling thread is one of the workers and only free threads of the pool
+// are added to it, so it can be called from a task of the pool.
+// If grain < 1, it will be calculated from the range size and the number of
+// threads.
+void workStealingFor(const Range &range,
+                     qint64 grain,
+                     const std::function<void (const Range &chunk)> &function);
+
+inline void workStealingFor(const Range &range,
+                            const std::function<void (const Range &chunk)> &function)
+{
+    workStealingFor(range, 0, function);
+}
+
+#endif // WORKSTEALING_H